@@ -1,11 +1,14 @@
+#include "branch_and_bound.hpp"
 #include "build_info.hpp"
+#include "key_transform.hpp"
 #include "knapsack_instance.hpp"
 #include "task.hpp"
-#include "termination_detection.hpp"
 #include "wrapper/selector.hpp"
 
 #include "cxxopts.hpp"
 
+#include <sys/resource.h>
+#include <x86intrin.h>
 #include <algorithm>
 #include <array>
 #include <atomic>
@@ -20,6 +23,9 @@
 #include <new>
 #include <numeric>
 #include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <type_traits>
 #include <utility>
@@ -37,117 +43,426 @@ static constexpr auto num_numa_nodes = 16;
 #endif
 
 using pq_type = PQWrapper<false>;
-using handle_type = pq_type::handle_type;
 
 static_assert(sizeof(unsigned long) >= sizeof(std::uint64_t), "64bit unsigned long required");
 using payload_type = unsigned long;
 
-constexpr pq_type::value_type to_payload(long long upper_bound, std::size_t index, long long free_capacity,
-                                         long long value) noexcept {
+constexpr unsigned int index_bits = 24;
+constexpr unsigned int hint_bits = 32 - index_bits;
+
+// The key holds the upper bound (level) in the high 32 bits, followed by the item index and the offset of the
+// parent's critical item from where the node's bound search starts (at index + 1), saturated to `hint_bits`
+constexpr pq_type::value_type to_payload(long long upper_bound, std::size_t index, std::size_t critical,
+                                         long long free_capacity, long long value) noexcept {
     assert(upper_bound >= 0 && static_cast<unsigned long>(upper_bound) < 1UL << 32);
-    assert(index < (1UL << 32));
+    assert(index < (1UL << index_bits));
     assert(free_capacity >= 0 && static_cast<unsigned long>(free_capacity) < 1UL << 32);
     assert(value >= 0 && static_cast<unsigned long>(value) < 1UL << 32);
-    return pq_type::value_type{static_cast<unsigned long>(upper_bound) << 32 | static_cast<payload_type>(index),
+    auto hint_offset = critical > index + 1 ? std::min(critical - index - 1, (1UL << hint_bits) - 1) : 0UL;
+    return pq_type::value_type{static_cast<unsigned long>(upper_bound) << 32 |
+                                   static_cast<payload_type>(index) << hint_bits | hint_offset,
                                static_cast<payload_type>(free_capacity) << 32 | static_cast<payload_type>(value)};
 }
 
 struct Settings {
     int num_threads = 4;
     std::filesystem::path knapsack_file;
+    std::filesystem::path suite_file;
     int seed = 1;
+    unsigned int coarsen_shift = 0;
+    unsigned long coarsen_delta = 1;
+    std::string critical_search = "auto";
+    std::string bound = "dantzig";
+    bool bound_stats = false;
+    int dive_depth = 0;
+    long long dive_gap = -1;
+    unsigned int incumbent_refresh = 16;
+    bool reduce = false;
+    bool early_termination = false;
+    unsigned long long dp_cutoff = 0;
+    bool queue_size = false;
+
+    [[nodiscard]] key_transform::Coarsening coarsening() const {
+        return key_transform::Coarsening::from_options(coarsen_shift, coarsen_delta);
+    }
 };
 
 void write_settings(Settings const& settings, std::ostream& out) {
     out << "Threads: " << settings.num_threads << '\n'
         << "Seed: " << settings.seed << '\n'
-        << "Problem file: " << settings.knapsack_file << '\n';
+        << "Problem file: " << settings.knapsack_file << '\n'
+        << "Suite file: " << settings.suite_file << '\n'
+        << "Key coarsening: " << settings.coarsening() << '\n'
+        << "Critical item search: " << settings.critical_search << '\n'
+        << "Upper bound: " << settings.bound << '\n'
+        << "Dive depth: " << settings.dive_depth << '\n'
+        << "Incumbent refresh interval: " << settings.incumbent_refresh << '\n'
+        << "Reduction: " << (settings.reduce ? "yes" : "no") << '\n'
+        << "Early termination: " << (settings.early_termination ? "yes" : "no") << '\n'
+        << "DP cut-off: " << settings.dp_cutoff << '\n'
+        << "Track queue size: " << (settings.queue_size ? "yes" : "no") << '\n';
+    if (settings.dive_gap >= 0) {
+        out << "Dive gap: " << settings.dive_gap << '\n';
+    }
 }
 
 struct ThreadStats {
-    long long pushed_nodes{0};
-    long long processed_nodes{0};
-    long long ignored_nodes{0};
+    branch_and_bound::ThreadStats<long long> search{};
+    long long bound_evaluations{0};
+    unsigned long long bound_cycles{0};
+    // Nodes processed right after their parent instead of being pushed and popped
+    long long dived_nodes{0};
+    // Nodes solved exactly by dynamic programming instead of branching
+    long long dp_nodes{0};
 };
 
 struct SharedData {
     KnapsackInstance<long long> instance;
-    std::atomic_llong solution{0};
-    termination_detection::Data termination_detection_data{};
+    CriticalSearch critical_search = CriticalSearch::linear;
+    BoundPolicy bound_policy = BoundPolicy::dantzig;
+    // Measure the cycles spent computing bounds
+    bool bound_stats = false;
+    // Threads follow the "take" child of a popped node for this many levels, or while the bound is at most
+    // `dive_gap` above the best solution (disabled if negative)
+    int dive_depth = 0;
+    long long dive_gap = -1;
+    // Nodes whose free capacity plus one times the number of remaining items is at most this are solved by dynamic
+    // programming (disabled if 0)
+    unsigned long long dp_cutoff = 0;
+    // Value of the items fixed by the reduction, the solver works on the remaining ones and starts from
+    // `initial_solution`
+    long long solution_offset = 0;
+    long long initial_solution = 0;
+    // Upper bounds are pushed as coarsened levels, on pop the largest bound of the level is used for pruning
+    key_transform::Coarsening coarsening{};
+    std::unique_ptr<branch_and_bound::SharedData<long long>> search;
+};
 
-    void update_solution(long long& current, long long update) noexcept {
-        while (update > current) {
-            if (solution.compare_exchange_weak(current, update, std::memory_order_relaxed)) {
-                current = update;
-            }
-        }
+// Branch and bound policy, nodes decide on the item at `index` and inherit the critical item of their parent as
+// search hint
+template <CriticalSearch Search, BoundPolicy Bound>
+class KnapsackProblem {
+    SharedData const& data_;
+    ThreadStats& stats_;
+    // Reused by all nodes the thread solves by dynamic programming
+    std::vector<long long> dp_table_;
+
+   public:
+    using value_type = long long;
+
+    struct node_type {
+        unsigned long level;
+        std::size_t index;
+        std::size_t critical_hint;
+        long long free_capacity;
+        long long value;
+    };
+
+    KnapsackProblem(SharedData const& data, ThreadStats& stats) noexcept : data_{data}, stats_{stats} {
     }
-};
 
-bool process_node(handle_type& handle, ThreadStats& stats, SharedData& data) {
-    auto node = handle.try_pop();
-    if (!node) {
-        return false;
+    [[nodiscard]] value_type initial_solution() const noexcept {
+        auto bounds = data_.instance.compute_bounds<CriticalSearch::binary>(data_.instance.capacity(), 0);
+        return std::max(bounds.lower, data_.initial_solution);
     }
-    ++stats.processed_nodes;
-    auto solution = data.solution.load(std::memory_order_relaxed);
-    auto upper_bound = static_cast<long long>(node->first >> 32);
-    if (upper_bound <= solution) {
-        ++stats.ignored_nodes;
-        return true;
-    }
-    auto index = static_cast<std::size_t>(node->first & ((1UL << 32) - 1));
-    auto free_capacity = static_cast<long long>(node->second >> 32);
-    assert(free_capacity <= data.instance.capacity());
-    auto value = static_cast<long long>(node->second & ((1UL << 32) - 1));
-    auto [lb, ub] = data.instance.compute_bounds_linear(free_capacity, index + 1);
-    data.update_solution(solution, value + lb);
-    if (index + 2 < data.instance.size()) {
-        if (value + ub > solution) {
-            handle.push(to_payload(value + ub, index + 1, free_capacity, value));
-            ++stats.pushed_nodes;
+
+    template <typename Context>
+    void root(Context& context) {
+        auto bounds = data_.instance.compute_bounds<CriticalSearch::binary, Bound>(data_.instance.capacity(), 0);
+        if (bounds.upper > context.best()) {
+            context.push({data_.coarsening(static_cast<unsigned long>(bounds.upper)), 0, bounds.critical,
+                          data_.instance.capacity(), 0});
         }
-        if (free_capacity >= data.instance.weight(index)) {
-            handle.push(to_payload(upper_bound, index + 1, free_capacity - data.instance.weight(index),
-                                   value + data.instance.value(index)));
-            ++stats.pushed_nodes;
+    }
+
+    [[nodiscard]] pq_type::value_type encode(node_type const& node) const noexcept {
+        return to_payload(static_cast<long long>(node.level), node.index, node.critical_hint, node.free_capacity,
+                          node.value);
+    }
+
+    [[nodiscard]] static node_type decode(pq_type::value_type const& entry) noexcept {
+        auto index = static_cast<std::size_t>((entry.first >> hint_bits) & ((1UL << index_bits) - 1));
+        return {entry.first >> 32, index, index + 1 + static_cast<std::size_t>(entry.first & ((1UL << hint_bits) - 1)),
+                static_cast<long long>(entry.second >> 32), static_cast<long long>(entry.second & ((1UL << 32) - 1))};
+    }
+
+    [[nodiscard]] value_type upper_bound(node_type const& node) const noexcept {
+        return static_cast<long long>(data_.coarsening.max_key(node.level));
+    }
+
+    [[nodiscard]] value_type key_bound(pq_type::key_type key) const noexcept {
+        return static_cast<long long>(data_.coarsening.max_key(key >> 32));
+    }
+
+    [[nodiscard]] bool below_dp_cutoff(node_type const& node) const noexcept {
+        auto cells = static_cast<unsigned long long>(node.free_capacity + 1) * (data_.instance.size() - node.index);
+        return cells <= data_.dp_cutoff;
+    }
+
+    template <typename Context>
+    void branch(node_type node, Context& context) {
+        assert(node.free_capacity <= data_.instance.capacity());
+        auto upper_bound = this->upper_bound(node);
+        // Diving follows the "take" child without going through the queue, it inherits the bound of the popped node
+        for (int depth = 0;; ++depth) {
+            if (below_dp_cutoff(node)) {
+                context.improve(node.value + data_.instance.solve_suffix(node.free_capacity, node.index, dp_table_));
+                ++stats_.dp_nodes;
+                break;
+            }
+            unsigned long long start_cycles = data_.bound_stats ? __rdtsc() : 0;
+            auto bounds =
+                data_.instance.compute_bounds<Search, Bound>(node.free_capacity, node.index + 1, node.critical_hint);
+            if (data_.bound_stats) {
+                stats_.bound_cycles += __rdtsc() - start_cycles;
+            }
+            ++stats_.bound_evaluations;
+            auto solution = context.improve(node.value + bounds.lower);
+            if (node.index + 2 >= data_.instance.size()) {
+                break;
+            }
+            if (node.value + bounds.upper > solution) {
+                context.push({data_.coarsening(static_cast<unsigned long>(node.value + bounds.upper)), node.index + 1,
+                              bounds.critical, node.free_capacity, node.value});
+            }
+            if (node.free_capacity < data_.instance.weight(node.index)) {
+                break;
+            }
+            node.free_capacity -= data_.instance.weight(node.index);
+            node.value += data_.instance.value(node.index);
+            ++node.index;
+            node.critical_hint = bounds.critical;
+            bool dive = depth < data_.dive_depth || (data_.dive_gap >= 0 && upper_bound - solution <= data_.dive_gap);
+            if (!dive) {
+                context.push(node);
+                break;
+            }
+            ++stats_.dived_nodes;
+            if (upper_bound <= solution) {
+                break;
+            }
         }
     }
-    return true;
+};
+
+template <CriticalSearch Search, BoundPolicy Bound>
+void run_search(task::Control& tc, pq_type& pq, ThreadStats& stats, SharedData& data) {
+    KnapsackProblem<Search, Bound> problem{data, stats};
+    stats.search = branch_and_bound::run_thread(tc, pq, problem, *data.search);
+}
+
+template <CriticalSearch Search>
+void run_search_with_bound(task::Control& tc, pq_type& pq, ThreadStats& stats, SharedData& data) {
+    switch (data.bound_policy) {
+        case BoundPolicy::dantzig:
+            run_search<Search, BoundPolicy::dantzig>(tc, pq, stats, data);
+            break;
+        case BoundPolicy::martello_toth:
+            run_search<Search, BoundPolicy::martello_toth>(tc, pq, stats, data);
+            break;
+        case BoundPolicy::mueller_merbach:
+            run_search<Search, BoundPolicy::mueller_merbach>(tc, pq, stats, data);
+            break;
+    }
 }
 
 ThreadStats benchmark_thread(task::Control tc, pq_type& pq, SharedData& data) {
     ThreadStats stats;
-    auto handle = pq.get_handle();
-    if (tc.id() == 0) {
-        auto [lb, ub] = data.instance.compute_bounds_linear(data.instance.capacity(), 0);
-        data.solution.store(lb, std::memory_order_relaxed);
-        if (ub > lb) {
-            handle.push(to_payload(ub, 0, data.instance.capacity(), 0));
-            ++stats.pushed_nodes;
+    switch (data.critical_search) {
+        case CriticalSearch::linear:
+            run_search_with_bound<CriticalSearch::linear>(tc, pq, stats, data);
+            break;
+        case CriticalSearch::binary:
+            run_search_with_bound<CriticalSearch::binary>(tc, pq, stats, data);
+            break;
+        case CriticalSearch::galloping:
+            run_search_with_bound<CriticalSearch::galloping>(tc, pq, stats, data);
+            break;
+        case CriticalSearch::simd:
+            run_search_with_bound<CriticalSearch::simd>(tc, pq, stats, data);
+            break;
+    }
+    return stats;
+}
+
+// Root upper bound of the original instance with the selected policy and, for comparison, with Dantzig's bound,
+// which every other policy tightens
+void write_root_bounds(SharedData const& data, long long solution, std::ostream& out) {
+    auto const& instance = data.instance;
+    auto root_bound = [&](BoundPolicy policy) {
+        switch (policy) {
+            case BoundPolicy::martello_toth:
+                return instance.compute_bounds<CriticalSearch::binary, BoundPolicy::martello_toth>(instance.capacity(),
+                                                                                                  0);
+            case BoundPolicy::mueller_merbach:
+                return instance.compute_bounds<CriticalSearch::binary, BoundPolicy::mueller_merbach>(
+                    instance.capacity(), 0);
+            default:
+                return instance.compute_bounds<CriticalSearch::binary>(instance.capacity(), 0);
+        }
+    };
+    out << "Root upper bounds (gap to the solution):";
+    for (auto policy : {BoundPolicy::dantzig, data.bound_policy}) {
+        auto upper = data.solution_offset + root_bound(policy).upper;
+        out << ' ' << to_string(policy) << ' ' << upper << " ("
+            << 100.0 * static_cast<double>(upper - solution) / static_cast<double>(std::max(solution, 1LL)) << "%)";
+        if (data.bound_policy == BoundPolicy::dantzig) {
+            break;
         }
     }
-    tc.synchronize();
-    while (termination_detection::try_do(tc.num_threads(), data.termination_detection_data,
-                                         [&]() { return process_node(handle, stats, data); })) {
+    out << '\n';
+}
+
+// Times the critical item searches on random subproblems whose hint is the critical item of a possible parent, and
+// returns the fastest
+CriticalSearch select_critical_search(KnapsackInstance<long long> const& instance, int seed) {
+    struct Query {
+        long long capacity;
+        std::size_t index;
+        std::size_t hint;
+    };
+    constexpr std::size_t num_queries = 1 << 14;
+    std::mt19937_64 rng(static_cast<std::mt19937_64::result_type>(seed));
+    std::uniform_int_distribution<std::size_t> index_dist(1, instance.size() - 1);
+    std::uniform_int_distribution<long long> capacity_dist(0, instance.capacity());
+    std::bernoulli_distribution take_dist;
+    std::vector<Query> queries(num_queries);
+    for (auto& query : queries) {
+        query.index = index_dist(rng);
+        query.capacity = capacity_dist(rng);
+        auto parent_capacity = query.capacity + (take_dist(rng) ? instance.weight(query.index - 1) : 0);
+        query.hint = instance.critical_item_binary(parent_capacity, query.index - 1);
     }
-    tc.synchronize();
-    return stats;
+    auto measure = [&](auto search) {
+        long long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto const& query : queries) {
+            checksum += instance.compute_bounds<decltype(search)::value>(query.capacity, query.index, query.hint).upper;
+        }
+        auto end = std::chrono::steady_clock::now();
+        // Keeps the loop from being optimized away
+        asm volatile("" : : "r"(checksum));
+        return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(num_queries);
+    };
+    std::array<std::pair<CriticalSearch, double>, 4> times{{
+        {CriticalSearch::linear, measure(std::integral_constant<CriticalSearch, CriticalSearch::linear>{})},
+        {CriticalSearch::binary, measure(std::integral_constant<CriticalSearch, CriticalSearch::binary>{})},
+        {CriticalSearch::galloping, measure(std::integral_constant<CriticalSearch, CriticalSearch::galloping>{})},
+        {CriticalSearch::simd, measure(std::integral_constant<CriticalSearch, CriticalSearch::simd>{})},
+    }};
+    std::clog << "Critical item search (ns per evaluation):";
+    for (auto const& [search, time] : times) {
+        std::clog << ' ' << to_string(search) << ' ' << std::fixed << std::setprecision(1) << time;
+    }
+    std::clog << '\n';
+    return std::min_element(times.begin(), times.end(), [](auto const& lhs, auto const& rhs) {
+               return lhs.second < rhs.second;
+           })->first;
 }
 
-bool run_benchmark(Settings const& settings, pq_type& pq) {
-    SharedData shared_data;
+// Loads and preprocesses `file` into the fresh `shared_data`
+bool prepare_instance(Settings const& settings, std::filesystem::path const& file, SharedData& shared_data) {
+    shared_data.coarsening = settings.coarsening();
+    auto load_start = std::chrono::steady_clock::now();
     try {
-        shared_data.instance = KnapsackInstance(settings.knapsack_file);
+        shared_data.instance = KnapsackInstance<long long>(file, static_cast<unsigned int>(settings.num_threads));
     } catch (std::runtime_error const& e) {
         std::clog << "Error reading problem file: " << e.what() << std::endl;
         return false;
     }
+    std::clog << "Load time (s): " << std::fixed << std::setprecision(3)
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - load_start).count() << '\n';
+
+    if (settings.reduce) {
+        auto reduce_start = std::chrono::steady_clock::now();
+        auto original_size = shared_data.instance.size();
+        auto reduction = shared_data.instance.reduce(static_cast<unsigned int>(settings.num_threads));
+        shared_data.instance = std::move(reduction.instance);
+        shared_data.solution_offset = reduction.offset;
+        shared_data.initial_solution = reduction.lower_bound - reduction.offset;
+        std::clog << "Reduction time (s): " << std::fixed << std::setprecision(3)
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - reduce_start).count() << '\n';
+        auto ratio =
+            static_cast<double>(shared_data.instance.size()) / static_cast<double>(std::max(original_size, 1UL));
+        std::clog << "Reduced items: " << original_size << " -> " << shared_data.instance.size() << " ("
+                  << reduction.fixed_taken << " taken, " << reduction.fixed_skipped << " skipped, ratio "
+                  << std::setprecision(4) << ratio << ")\n";
+        std::clog << "Reduced capacity: " << shared_data.instance.capacity() << '\n';
+    }
 
-    if (shared_data.instance.size() + 1 >= (1UL << 32) || shared_data.instance.capacity() >= (1LL << 32)) {
+    if (shared_data.instance.size() + 1 >= (1UL << index_bits) || shared_data.instance.capacity() >= (1LL << 32)) {
         std::clog << "Error: Instance cannot be represented\n";
         return false;
     }
+    shared_data.bound_stats = settings.bound_stats;
+    shared_data.dive_depth = settings.dive_depth;
+    shared_data.dive_gap = settings.dive_gap;
+    shared_data.dp_cutoff = settings.dp_cutoff;
+    if (settings.incumbent_refresh == 0) {
+        std::clog << "Error: The incumbent refresh interval must be positive" << std::endl;
+        return false;
+    }
+    // affinity::NUMA places consecutive groups of `cores_per_numa_node` threads on the same node
+    shared_data.search = std::make_unique<branch_and_bound::SharedData<long long>>(
+        settings.num_threads, cores_per_numa_node, settings.incumbent_refresh);
+    if (settings.early_termination && !wrapper::util::has_best_key_bound_v<pq_type>) {
+        std::clog << "Error: The priority queue provides no best-key bound for early termination" << std::endl;
+        return false;
+    }
+    shared_data.search->early_termination = settings.early_termination;
+    shared_data.search->track_queue_size = settings.queue_size;
+    auto bounds = {BoundPolicy::dantzig, BoundPolicy::martello_toth, BoundPolicy::mueller_merbach};
+    auto bound = std::find_if(bounds.begin(), bounds.end(),
+                              [&](auto policy) { return settings.bound == to_string(policy); });
+    if (bound == bounds.end()) {
+        std::clog << "Error: Unknown upper bound " << settings.bound << std::endl;
+        return false;
+    }
+    shared_data.bound_policy = *bound;
+    if (settings.critical_search == "auto") {
+        shared_data.critical_search = shared_data.instance.size() > 1
+            ? select_critical_search(shared_data.instance, settings.seed)
+            : CriticalSearch::linear;
+    } else {
+        auto searches = {CriticalSearch::linear, CriticalSearch::binary, CriticalSearch::galloping,
+                         CriticalSearch::simd};
+        auto it = std::find_if(searches.begin(), searches.end(),
+                               [&](auto search) { return settings.critical_search == to_string(search); });
+        if (it == searches.end()) {
+            std::clog << "Error: Unknown critical item search " << settings.critical_search << std::endl;
+            return false;
+        }
+        shared_data.critical_search = *it;
+    }
+    std::clog << "Using " << to_string(shared_data.critical_search) << " critical item search\n";
+    return true;
+}
+
+// Peak resident set size of the process, including the instance
+double peak_memory_mib() noexcept {
+    rusage usage{};
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+}
+
+ThreadStats accumulate_stats(std::vector<ThreadStats> const& all_stats) {
+    return std::accumulate(all_stats.begin() + 1, all_stats.end(), all_stats.front(), [](auto accum, auto const& e) {
+        accum.search = branch_and_bound::accumulate(accum.search, e.search);
+        accum.bound_evaluations += e.bound_evaluations;
+        accum.bound_cycles += e.bound_cycles;
+        accum.dived_nodes += e.dived_nodes;
+        accum.dp_nodes += e.dp_nodes;
+        return accum;
+    });
+}
+
+bool run_benchmark(Settings const& settings, pq_type& pq) {
+    SharedData shared_data;
+    if (!prepare_instance(settings, settings.knapsack_file, shared_data)) {
+        return false;
+    }
     std::vector<ThreadStats> all_stats(static_cast<std::size_t>(settings.num_threads));
     affinity::NUMA numa_affinity{cores_per_numa_node, num_numa_nodes};
     std::clog << "Working...\n";
@@ -158,29 +473,156 @@ bool run_benchmark(Settings const& settings, pq_type& pq) {
     runner.wait();
     auto end_time = std::chrono::steady_clock::now();
     std::clog << "Finished\n" << std::endl;
-    auto accum_stats =
-        std::accumulate(all_stats.begin() + 1, all_stats.end(), all_stats.front(), [](auto accum, auto const& e) {
-            accum.pushed_nodes += e.pushed_nodes;
-            accum.processed_nodes += e.processed_nodes;
-            accum.ignored_nodes += e.ignored_nodes;
-            return accum;
-        });
-    std::clog << "Time (s): " << std::fixed << std::setprecision(3)
-              << std::chrono::duration<double>(end_time - start_time).count() << '\n';
-    std::clog << "Solution: " << shared_data.solution.load() << '\n';
-    std::clog << "Processed nodes: " << accum_stats.processed_nodes << '\n';
-    std::clog << "Ignored nodes: " << accum_stats.ignored_nodes << '\n';
-    if (accum_stats.processed_nodes != accum_stats.pushed_nodes) {
+    auto accum_stats = accumulate_stats(all_stats);
+    auto time = std::chrono::duration<double>(end_time - start_time).count();
+    std::clog << "Time (s): " << std::fixed << std::setprecision(3) << time << '\n';
+    std::clog << "Pops per second: " << static_cast<double>(accum_stats.search.processed_nodes) / time << '\n';
+    std::clog << "Solution: " << shared_data.solution_offset + shared_data.search->incumbent.load() << '\n';
+    std::clog << "Processed nodes: " << accum_stats.search.processed_nodes << '\n';
+    std::clog << "Ignored nodes: " << accum_stats.search.ignored_nodes << '\n';
+    write_root_bounds(shared_data, shared_data.solution_offset + shared_data.search->incumbent.load(), std::clog);
+    if (settings.queue_size) {
+        std::clog << "Peak queue size: " << shared_data.search->peak_queue_size.load() << '\n';
+    }
+    std::clog << "Dived nodes: " << accum_stats.dived_nodes << '\n';
+    std::clog << "Saved queue operations: " << 2 * accum_stats.dived_nodes << '\n';
+    if (settings.dp_cutoff > 0) {
+        auto branched = accum_stats.search.processed_nodes - accum_stats.search.ignored_nodes + accum_stats.dived_nodes;
+        std::clog << "DP cut-off nodes: " << accum_stats.dp_nodes << " ("
+                  << 100.0 * static_cast<double>(accum_stats.dp_nodes) / static_cast<double>(std::max(branched, 1LL))
+                  << "% of expanded nodes)\n";
+    }
+    std::clog << "Incumbent updates (global/NUMA): " << accum_stats.search.incumbent.global_updates << '/'
+              << accum_stats.search.incumbent.local_updates << '\n';
+    std::clog << "Incumbent transfers: " << accum_stats.search.incumbent.transfers << " in "
+              << accum_stats.search.incumbent.refreshes << " refreshes\n";
+    std::clog << "Peak memory (MiB): " << peak_memory_mib() << '\n';
+#ifdef PQ_WORK_STEALING
+    std::clog << "Peak deque entries (sum over threads): " << pq.max_size() << '\n';
+    std::clog << "Deque memory (MiB): " << static_cast<double>(pq.allocated_bytes()) / (1024.0 * 1024.0) << '\n';
+#endif
+    if (settings.bound_stats && accum_stats.bound_evaluations > 0) {
+        std::clog << "Bound evaluation (cycles per node): "
+                  << static_cast<double>(accum_stats.bound_cycles) / static_cast<double>(accum_stats.bound_evaluations)
+                  << '\n';
+    }
+    if (settings.early_termination) {
+        std::clog << "Undrained nodes: " << accum_stats.search.pushed_nodes - accum_stats.search.processed_nodes
+                  << '\n';
+    } else if (accum_stats.search.processed_nodes != accum_stats.search.pushed_nodes) {
         std::clog << "Error: Not all nodes were popped" << std::endl;
         return false;
     }
-    std::cout << "time,processed,ignored,solution\n";
+    std::cout << "time,processed,ignored,dived,dp_solved,solution\n";
     std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << ','
-              << accum_stats.processed_nodes << ',' << accum_stats.ignored_nodes << ',' << shared_data.solution.load()
-              << '\n';
+              << accum_stats.search.processed_nodes << ',' << accum_stats.search.ignored_nodes << ','
+              << accum_stats.dived_nodes << ',' << accum_stats.dp_nodes << ','
+              << shared_data.solution_offset + shared_data.search->incumbent.load() << '\n';
     return true;
 }
 
+struct SuiteEntry {
+    std::filesystem::path file;
+    long long expected_solution;
+    // Negative if not given
+    double reference_time;
+};
+
+// Each line holds an instance path, its optimal value and optionally a reference time in seconds
+std::vector<SuiteEntry> read_suite(std::filesystem::path const& suite_file) {
+    std::ifstream in{suite_file};
+    if (!in) {
+        throw std::runtime_error{"Could not open file"};
+    }
+    std::vector<SuiteEntry> suite;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream line_stream{line};
+        SuiteEntry entry{};
+        std::string file;
+        if (!(line_stream >> file)) {
+            continue;
+        }
+        if (!(line_stream >> entry.expected_solution)) {
+            throw std::runtime_error{"Missing expected solution for " + file};
+        }
+        if (!(line_stream >> entry.reference_time)) {
+            entry.reference_time = -1.0;
+        }
+        entry.file = file;
+        suite.push_back(std::move(entry));
+    }
+    return suite;
+}
+
+// Solves the instances one after another on the same pinned threads with a new queue each, and checks the results
+bool run_suite(Settings const& settings, cxxopts::ParseResult const& args) {
+    std::vector<SuiteEntry> suite;
+    try {
+        suite = read_suite(settings.suite_file);
+    } catch (std::runtime_error const& e) {
+        std::clog << "Error reading suite file: " << e.what() << std::endl;
+        return false;
+    }
+    std::clog << "Instances: " << suite.size() << "\n\n";
+    std::cout << "instance,expected,solution,correct,time,processed,ignored,reference_time,speedup\n";
+
+    SharedData shared_data;
+    std::unique_ptr<pq_type> pq;
+    bool prepared = false;
+    int num_correct = 0;
+    std::vector<ThreadStats> all_stats(static_cast<std::size_t>(settings.num_threads));
+    std::chrono::steady_clock::time_point start_time;
+    affinity::NUMA numa_affinity{cores_per_numa_node, num_numa_nodes};
+    task::Runner runner{
+        numa_affinity, settings.num_threads, [&](auto tc) {
+            for (std::size_t i = 0; i < suite.size(); ++i) {
+                if (tc.id() == 0) {
+                    std::clog << "Instance " << i + 1 << '/' << suite.size() << ": " << suite[i].file << '\n';
+                    shared_data = SharedData{};
+                    prepared = prepare_instance(settings, suite[i].file, shared_data);
+                    if (prepared) {
+                        // Direct initialization, not all queues are movable
+                        pq.reset(new pq_type(create<false>(settings.num_threads, 1 << 24, args)));
+                    }
+                    start_time = std::chrono::steady_clock::now();
+                }
+                tc.synchronize();
+                // Thread 0 only writes `prepared` again after the next barrier
+                if (prepared) {
+                    all_stats[static_cast<std::size_t>(tc.id())] = benchmark_thread(tc, *pq, shared_data);
+                }
+                tc.synchronize();
+                if (tc.id() != 0 || !prepared) {
+                    continue;
+                }
+                auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+                auto accum_stats = accumulate_stats(all_stats);
+                auto solution = shared_data.solution_offset + shared_data.search->incumbent.load();
+                bool correct = solution == suite[i].expected_solution &&
+                    (settings.early_termination ||
+                     accum_stats.search.processed_nodes == accum_stats.search.pushed_nodes);
+                num_correct += correct ? 1 : 0;
+                std::clog << "Time (s): " << std::fixed << std::setprecision(3) << time << '\n'
+                          << "Solution: " << solution << " (expected " << suite[i].expected_solution << ") "
+                          << (correct ? "OK" : "WRONG") << "\n\n";
+                std::cout << suite[i].file.string() << ',' << suite[i].expected_solution << ',' << solution << ','
+                          << (correct ? 1 : 0) << ',' << std::setprecision(6) << time << ','
+                          << accum_stats.search.processed_nodes << ',' << accum_stats.search.ignored_nodes << ',';
+                if (suite[i].reference_time >= 0) {
+                    std::cout << suite[i].reference_time << ',' << suite[i].reference_time / time;
+                } else {
+                    std::cout << ',';
+                }
+                std::cout << std::endl;
+            }
+        }};
+    runner.wait();
+    pq.reset();
+    std::clog << "Correct: " << num_correct << '/' << suite.size() << std::endl;
+    return num_correct == static_cast<int>(suite.size());
+}
+
 int main(int argc, char* argv[]) {
     write_build_info(std::clog);
     std::clog << "\nCommand line:";
@@ -195,6 +637,20 @@ int main(int argc, char* argv[]) {
     cmd.add_options()
       ("j,threads", "The number of threads", cxxopts::value<int>(settings.num_threads), "NUMBER")
       ("file", "The input graph", cxxopts::value<std::filesystem::path>(settings.knapsack_file), "PATH")
+      ("suite", "Solve all instances listed in this file (path, optimal value, reference time) and check the results", cxxopts::value<std::filesystem::path>(settings.suite_file), "PATH")
+      ("coarsen-shift", "Drop this many low bits of the upper bound keys", cxxopts::value<unsigned int>(settings.coarsen_shift), "NUMBER")
+      ("coarsen-delta", "Divide the upper bound keys by this value (excludes --coarsen-shift)", cxxopts::value<unsigned long>(settings.coarsen_delta), "NUMBER")
+      ("critical-search", "How to search the critical item (auto, linear, binary, galloping, simd)", cxxopts::value<std::string>(settings.critical_search), "METHOD")
+      ("bound", "Upper bound of the subproblems (dantzig, martello-toth, mueller-merbach)", cxxopts::value<std::string>(settings.bound), "BOUND")
+      ("queue-size", "Track the number of queued nodes to report the peak, costs a shared counter update per operation", cxxopts::value<bool>(settings.queue_size))
+      ("bound-stats", "Measure the cycles spent computing bounds", cxxopts::value<bool>(settings.bound_stats))
+      ("dive-depth", "Follow the take child of popped nodes for this many levels without using the queue", cxxopts::value<int>(settings.dive_depth), "NUMBER")
+      ("dive-gap", "Also keep diving while the bound is at most this much above the best solution", cxxopts::value<long long>(settings.dive_gap), "NUMBER")
+      ("incumbent-refresh", "Refresh the cached best solution every this many nodes", cxxopts::value<unsigned int>(settings.incumbent_refresh), "NUMBER")
+      ("reduce", "Fix items by bound tests before branch and bound", cxxopts::value<bool>(settings.reduce))
+      ("dp-cutoff", "Solve nodes with at most this many capacity times item cells by dynamic programming (0 disables)", cxxopts::value<unsigned long long>(settings.dp_cutoff), "NUMBER")
+      ("early-termination", "Stop once the best key in the queue cannot beat the best solution (not all queues)", cxxopts::value<bool>(settings.early_termination))
+      ("s,seed", "Seed for choosing the critical item search", cxxopts::value<int>(settings.seed), "NUMBER")
       ("h,help", "Print this help");
     // clang-format on
     add_options(cmd);
@@ -213,8 +669,20 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
+    try {
+        // Only validates the options
+        (void)settings.coarsening();
+    } catch (std::invalid_argument const& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
     write_settings(settings, std::clog);
 
+    if (!settings.suite_file.empty()) {
+        return run_suite(settings, args) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     if (settings.knapsack_file.empty()) {
         std::cerr << "Error: No instance file specified" << std::endl;
         std::cerr << cmd.help() << std::endl;
@@ -1,5 +1,13 @@
 #include "build_info.hpp"
+#include "incumbent.hpp"
+#include "key_transform.hpp"
 #include "knapsack_instance.hpp"
+#ifdef NODE_POOL
+#include "node_pool.hpp"
+#endif
+#ifdef PAYLOAD_ADAPTOR
+#include "payload_adaptor.hpp"
+#endif
 #include "task.hpp"
 #include "termination_detection.hpp"
 #include "wrapper/selector.hpp"
@@ -19,6 +27,7 @@
 #include <memory>
 #include <new>
 #include <numeric>
+#include <optional>
 #include <random>
 #include <thread>
 #include <type_traits>
@@ -43,24 +52,63 @@ struct Node {
     double value;
 };
 
+#if defined NODE_POOL && defined PAYLOAD_ADAPTOR
+#error NODE_POOL and PAYLOAD_ADAPTOR are exclusive
+#endif
+
+#ifdef NODE_POOL
+// The queue only carries the upper bound and a handle into the node pool
+struct PoolNode {
+    std::size_t index;
+    double free_capacity;
+    double value;
+};
+
+using pq_type = PQWrapper<false>;
+#else
 struct NodePriority {
     static double get(Node const& node) noexcept {
         return node.upper_bound;
     }
 };
 
+#ifdef PAYLOAD_ADAPTOR
+// For queues that only store pairs of unsigned longs, nodes are stored out-of-line
+using pq_type = PayloadAdaptor<PQWrapper<false>, double, Node, NodePriority>;
+static constexpr std::size_t queue_entry_size = sizeof(pq_type::base_type::value_type);
+#else
 using pq_type = PQWrapper<false, double, Node, NodePriority>;
+#endif
+#endif
+#ifndef PAYLOAD_ADAPTOR
+static constexpr std::size_t queue_entry_size = sizeof(pq_type::value_type);
+#endif
 using handle_type = pq_type::handle_type;
 
 struct Settings {
     int num_threads = 4;
     std::filesystem::path knapsack_file;
     int seed = 1;
-    pq_type::config_type pq_settings{};
+    unsigned int truncate_bits = 0;
+    unsigned int incumbent_refresh = 16;
+    bool early_termination = false;
+#ifdef NODE_POOL
+    bool return_home = false;
+#endif
 
     void options(cxxopts::Options& cmd) {
         cmd.add_options()("j,threads", "The number of threads", cxxopts::value<int>(num_threads), "NUMBER")(
-            "file", "The input graph", cxxopts::value<std::filesystem::path>(knapsack_file), "PATH");
+            "file", "The input graph", cxxopts::value<std::filesystem::path>(knapsack_file), "PATH")(
+            "truncate-bits", "Round upper bounds up to clear this many low mantissa bits",
+            cxxopts::value<unsigned int>(truncate_bits), "NUMBER")(
+            "incumbent-refresh", "Refresh the cached best solution every this many nodes",
+            cxxopts::value<unsigned int>(incumbent_refresh), "NUMBER")(
+            "early-termination", "Stop once the best key in the queue cannot beat the best solution (not all queues)",
+            cxxopts::value<bool>(early_termination));
+#ifdef NODE_POOL
+        cmd.add_options()("return-home", "Return freed nodes to the arena of the allocating thread",
+                          cxxopts::value<bool>(return_home));
+#endif
         cmd.parse_positional({"file"});
     }
 };
@@ -68,51 +116,113 @@ struct Settings {
 void write_settings(Settings const& settings, std::ostream& out) {
     out << "Threads: " << settings.num_threads << '\n'
         << "Seed: " << settings.seed << '\n'
-        << "Problem file: " << settings.knapsack_file << '\n';
+        << "Problem file: " << settings.knapsack_file << '\n'
+        << "Truncated key bits: " << settings.truncate_bits << '\n'
+        << "Incumbent refresh interval: " << settings.incumbent_refresh << '\n'
+        << "Early termination: " << (settings.early_termination ? "yes" : "no") << '\n';
+#ifdef NODE_POOL
+    out << "Node storage: pool" << (settings.return_home ? " (return home)" : "") << '\n';
+#elif defined PAYLOAD_ADAPTOR
+    out << "Node storage: out-of-line through the payload adaptor" << '\n';
+#else
+    out << "Node storage: by value" << '\n';
+#endif
 }
 
 struct ThreadStats {
     long long pushed_nodes{0};
     long long processed_nodes{0};
     long long ignored_nodes{0};
+    Incumbent<double>::Stats incumbent{};
 };
 
 struct SharedData {
     KnapsackInstance<double> instance;
-    std::atomic<double> solution{0};
+    std::unique_ptr<Incumbent<double>> solution;
+    // Rounding up keeps the truncated keys valid upper bounds
+    unsigned int truncate_bits = 0;
+    // Stop popping once the queue's best-key bound is no better than the incumbent
+    bool early_termination = false;
     termination_detection::Data termination_detection_data{};
+#ifdef NODE_POOL
+    std::unique_ptr<NodePool<PoolNode>> pool;
+#endif
+};
 
-    void update_solution(double& current, double update) noexcept {
-        while (update > current) {
-            if (solution.compare_exchange_weak(current, update, std::memory_order_relaxed)) {
-                current = update;
-            }
-        }
+#ifdef NODE_POOL
+void push_node(handle_type& handle, int id, SharedData& data, Node const& node) {
+    auto node_handle = data.pool->allocate(id, PoolNode{node.index, node.free_capacity, node.value});
+    handle.push({key_transform::to_ordered_bits(node.upper_bound), node_handle});
+}
+
+double key_bound(pq_type::key_type key) noexcept {
+    return key_transform::from_ordered_bits(key);
+}
+
+std::optional<Node> pop_node(handle_type& handle, int id, SharedData& data) {
+    auto entry = handle.try_pop();
+    if (!entry) {
+        return std::nullopt;
     }
-};
+    auto pool_node = (*data.pool)[entry->second];
+    data.pool->free(id, entry->second);
+    return Node{key_transform::from_ordered_bits(entry->first), pool_node.index, pool_node.free_capacity,
+                pool_node.value};
+}
+#else
+void push_node(handle_type& handle, int /*id*/, SharedData& /*data*/, Node const& node) {
+    handle.push(node);
+}
+
+double key_bound(pq_type::key_type key) noexcept {
+    return key;
+}
+
+std::optional<Node> pop_node(handle_type& handle, int /*id*/, SharedData& /*data*/) {
+    return handle.try_pop();
+}
+#endif
 
-bool process_node(handle_type& handle, ThreadStats& stats, SharedData& data) {
-    auto node = handle.try_pop();
+// False if the queue's best-key bound shows that no queued node can improve the solution
+template <typename PQ>
+bool queue_can_improve(PQ const& pq, double solution) {
+    if constexpr (wrapper::util::has_best_key_bound_v<PQ>) {
+        auto bound = pq.best_key_bound();
+        return bound && key_bound(*bound) > solution;
+    } else {
+        return true;
+    }
+}
+
+bool process_node(pq_type const& pq, handle_type& handle, int id, Incumbent<double>::View& incumbent,
+                  ThreadStats& stats, SharedData& data) {
+    if (data.early_termination && !queue_can_improve(pq, incumbent.get())) {
+        return false;
+    }
+    auto node = pop_node(handle, id, data);
     if (!node) {
         return false;
     }
     ++stats.processed_nodes;
-    auto solution = data.solution.load(std::memory_order_relaxed);
+    auto solution = incumbent.get();
     if (node->upper_bound <= solution) {
         ++stats.ignored_nodes;
         return true;
     }
     auto [lb, ub] = data.instance.compute_bounds_linear(node->free_capacity, node->index + 1);
-    data.update_solution(solution, node->value + lb);
+    solution = incumbent.update(node->value + lb);
     if (node->index + 2 < data.instance.size()) {
         if (node->value + ub > solution) {
-            handle.push({node->value + ub, node->index + 1, node->free_capacity, node->value});
+            push_node(handle, id, data,
+                      Node{key_transform::truncate_up(node->value + ub, data.truncate_bits), node->index + 1,
+                           node->free_capacity, node->value});
             ++stats.pushed_nodes;
         }
         if (node->free_capacity >= data.instance.weight(node->index)) {
-            auto payload = to_payload(node->index + 1, node->free_capacity - data.instance.weight(node->index),
-                                      node->value + data.instance.value(node->index));
-            handle.push({node->first, payload});
+            // Taking the item keeps the upper bound of the parent
+            push_node(handle, id, data,
+                      Node{node->upper_bound, node->index + 1, node->free_capacity - data.instance.weight(node->index),
+                           node->value + data.instance.value(node->index)});
             ++stats.pushed_nodes;
         }
     }
@@ -121,31 +231,52 @@ bool process_node(handle_type& handle, ThreadStats& stats, SharedData& data) {
 
 ThreadStats benchmark_thread(task::Control tc, pq_type& pq, SharedData& data) {
     ThreadStats stats;
-    auto handle = pq.get_handle();
+    handle_type handle = pq.get_handle();
     if (tc.id() == 0) {
         auto [lb, ub] = data.instance.compute_bounds_linear(data.instance.capacity(), 0);
-        data.solution.store(lb, std::memory_order_relaxed);
+        data.solution->reset(lb);
         if (ub > lb) {
-            handle.push({ub, 0, data.instance.capacity(), 0});
+            push_node(handle, tc.id(), data,
+                      Node{key_transform::truncate_up(ub, data.truncate_bits), 0, data.instance.capacity(), 0});
             ++stats.pushed_nodes;
         }
     }
     tc.synchronize();
+    // affinity::NUMA places consecutive groups of `cores_per_numa_node` threads on the same node
+    auto incumbent = data.solution->view(static_cast<std::size_t>(tc.id() / cores_per_numa_node));
     while (termination_detection::try_do(tc.num_threads(), data.termination_detection_data,
-                                         [&]() { return process_node(handle, stats, data); })) {
+                                         [&]() { return process_node(pq, handle, tc.id(), incumbent, stats, data); })) {
     }
+    stats.incumbent = incumbent.stats();
     tc.synchronize();
     return stats;
 }
 
 bool run_benchmark(Settings const& settings, pq_type& pq) {
     SharedData shared_data;
+    shared_data.truncate_bits = settings.truncate_bits;
     try {
-        shared_data.instance = KnapsackInstance<double>(settings.knapsack_file);
+        shared_data.instance =
+            KnapsackInstance<double>(settings.knapsack_file, static_cast<unsigned int>(settings.num_threads));
     } catch (std::runtime_error const& e) {
         std::clog << "Error reading problem file: " << e.what() << std::endl;
         return false;
     }
+    if (settings.incumbent_refresh == 0) {
+        std::clog << "Error: The incumbent refresh interval must be positive" << std::endl;
+        return false;
+    }
+    shared_data.solution = std::make_unique<Incumbent<double>>(
+        static_cast<std::size_t>((settings.num_threads + cores_per_numa_node - 1) / cores_per_numa_node),
+        settings.incumbent_refresh);
+    if (settings.early_termination && !wrapper::util::has_best_key_bound_v<pq_type>) {
+        std::clog << "Error: The priority queue provides no best-key bound for early termination" << std::endl;
+        return false;
+    }
+    shared_data.early_termination = settings.early_termination;
+#ifdef NODE_POOL
+    shared_data.pool = std::make_unique<NodePool<PoolNode>>(settings.num_threads, settings.return_home);
+#endif
 
     std::vector<ThreadStats> all_stats(static_cast<std::size_t>(settings.num_threads));
     affinity::NUMA numa_affinity{cores_per_numa_node, num_numa_nodes};
@@ -162,20 +293,44 @@ bool run_benchmark(Settings const& settings, pq_type& pq) {
             accum.pushed_nodes += e.pushed_nodes;
             accum.processed_nodes += e.processed_nodes;
             accum.ignored_nodes += e.ignored_nodes;
+            accum.incumbent.global_updates += e.incumbent.global_updates;
+            accum.incumbent.local_updates += e.incumbent.local_updates;
+            accum.incumbent.transfers += e.incumbent.transfers;
+            accum.incumbent.refreshes += e.incumbent.refreshes;
             return accum;
         });
-    std::clog << "Time (s): " << std::fixed << std::setprecision(3)
-              << std::chrono::duration<double>(end_time - start_time).count() << '\n';
-    std::clog << "Solution: " << shared_data.solution.load() << '\n';
+    auto seconds = std::chrono::duration<double>(end_time - start_time).count();
+    std::clog << "Time (s): " << std::fixed << std::setprecision(3) << seconds << '\n';
+    std::clog << "Solution: " << shared_data.solution->load() << '\n';
     std::clog << "Processed nodes: " << accum_stats.processed_nodes << '\n';
     std::clog << "Ignored nodes: " << accum_stats.ignored_nodes << '\n';
-    if (accum_stats.processed_nodes != accum_stats.pushed_nodes) {
+    std::clog << "Incumbent updates (global/NUMA): " << accum_stats.incumbent.global_updates << '/'
+              << accum_stats.incumbent.local_updates << '\n';
+    std::clog << "Incumbent transfers: " << accum_stats.incumbent.transfers << " in "
+              << accum_stats.incumbent.refreshes << " refreshes\n";
+    std::clog << "Throughput (nodes/s): " << std::setprecision(0)
+              << static_cast<double>(accum_stats.processed_nodes) / seconds << std::setprecision(3) << '\n';
+    std::clog << "Queue entry size (bytes): " << queue_entry_size << '\n';
+#ifdef PAYLOAD_ADAPTOR
+    std::clog << "Out-of-line payloads: " << pq.out_of_line_slots() << " slots ("
+              << static_cast<double>(pq.out_of_line_slots() * pq_type::slot_size()) / (1 << 20) << " MiB)\n";
+#endif
+#ifdef NODE_POOL
+    std::clog << "Pool slots: " << shared_data.pool->allocated_slots() << '\n';
+    std::clog << "Pool memory (MiB): "
+              << static_cast<double>(shared_data.pool->allocated_slots() * NodePool<PoolNode>::slot_size()) /
+                     (1 << 20)
+              << '\n';
+#endif
+    if (settings.early_termination) {
+        std::clog << "Undrained nodes: " << accum_stats.pushed_nodes - accum_stats.processed_nodes << '\n';
+    } else if (accum_stats.processed_nodes != accum_stats.pushed_nodes) {
         std::clog << "Error: Not all nodes were popped" << std::endl;
         return false;
     }
     std::cout << "time,processed,ignored,solution\n";
     std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << ','
-              << accum_stats.processed_nodes << ',' << accum_stats.ignored_nodes << ',' << shared_data.solution.load()
+              << accum_stats.processed_nodes << ',' << accum_stats.ignored_nodes << ',' << shared_data.solution->load()
               << '\n';
     return true;
 }
@@ -215,9 +370,20 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
+#ifdef NODE_POOL
+    auto pq = create<false>(settings.num_threads, 1 << 24, args);
+#elif defined PAYLOAD_ADAPTOR
+    pq_type pq{settings.num_threads, [&]() { return create<false>(settings.num_threads, 1 << 24, args); }};
+#else
     auto pq = create<false, double, Node, NodePriority>(settings.num_threads, 1 << 24, args);
+#endif
     std::clog << "Priority queue: ";
-    describe(pq, std::clog) << '\n' << '\n';
+#ifdef PAYLOAD_ADAPTOR
+    describe(pq.base(), std::clog) << " with payload adaptor";
+#else
+    describe(pq, std::clog);
+#endif
+    std::clog << '\n' << '\n';
     bool success = run_benchmark(settings, pq);
     return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -14,6 +14,7 @@
 #include <vector>
 
 using payload_type = unsigned long;
+using instance_type = KnapsackInstance<long long>;
 
 struct Node {
     long long upper_bound;
@@ -37,7 +38,7 @@ struct Data {
     long long processed_nodes{0};
 };
 
-void knapsack(pq_type& pq, Data& data, KnapsackInstance const& instance) noexcept {
+void knapsack(pq_type& pq, Data& data, instance_type const& instance) noexcept {
     while (!pq.empty()) {
 #ifdef USE_FIFO
         auto node = pq.front();
@@ -47,7 +48,12 @@ void knapsack(pq_type& pq, Data& data, KnapsackInstance const& instance) noexcep
         pq.pop();
         ++data.processed_nodes;
         if (node.upper_bound <= data.best_value) {
+#ifdef USE_FIFO
+            continue;
+#else
+            // All remaining nodes have smaller bounds
             return;
+#endif
         }
         auto const& [lb, ub] = instance.compute_bounds_linear(node.free_capacity, node.index + 1);
         if (node.value + lb > data.best_value) {
@@ -97,9 +103,9 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    KnapsackInstance instance;
+    instance_type instance;
     try {
-        instance = KnapsackInstance(instance_file);
+        instance = instance_type(instance_file);
     } catch (std::runtime_error const& e) {
         std::clog << "failed: " << e.what() << std::endl;
         return 1;
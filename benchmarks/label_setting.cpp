@@ -0,0 +1,154 @@
+#include "build_info.hpp"
+#include "graph.hpp"
+#include "label_setting.hpp"
+#include "path_algebra.hpp"
+#include "task.hpp"
+#include "wrapper/selector.hpp"
+
+#include "cxxopts.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#ifdef CORES_PER_NUMA_NODE
+static constexpr auto cores_per_numa_node = CORES_PER_NUMA_NODE;
+#else
+static constexpr auto cores_per_numa_node = 4;
+#endif
+#ifdef NUM_NUMA_NODES
+static constexpr auto num_numa_nodes = NUM_NUMA_NODES;
+#else
+static constexpr auto num_numa_nodes = 16;
+#endif
+
+#if defined ALGEBRA_WIDEST_PATH
+using algebra_type = path_algebra::WidestPath;
+#elif defined ALGEBRA_MOST_RELIABLE_PATH
+using algebra_type = path_algebra::MostReliablePath;
+#else
+using algebra_type = path_algebra::ShortestPath;
+#endif
+
+using pq_type = PQWrapper<algebra_type::min_queue>;
+using shared_data_type = label_setting::SharedData<algebra_type>;
+
+struct Settings {
+    int num_threads = 4;
+    std::filesystem::path graph_file;
+    std::filesystem::path label_file;
+};
+
+void write_settings(Settings const& settings, std::ostream& out) {
+    out << "Threads: " << settings.num_threads << '\n'
+        << "Graph: " << settings.graph_file.string() << '\n'
+        << "Algebra: " << algebra_type::name;
+    out << "\n\n";
+}
+
+bool run_benchmark(Settings const& settings, pq_type& pq) {
+    std::ofstream label_out;
+    if (!settings.label_file.empty()) {
+        label_out = std::ofstream(settings.label_file);
+        if (!label_out) {
+            std::cerr << "Error: Could not open file " << settings.label_file << " for writing" << std::endl;
+            return false;
+        }
+    }
+
+    std::clog << "Reading graph..." << std::endl;
+    Graph graph;
+    try {
+        graph = Graph(settings.graph_file);
+    } catch (std::runtime_error const& e) {
+        std::clog << "Error: " << e.what() << std::endl;
+        return false;
+    }
+    shared_data_type shared_data{graph};
+
+    std::vector<label_setting::ThreadStats> all_stats(static_cast<std::size_t>(settings.num_threads));
+    affinity::NUMA numa_affinity{cores_per_numa_node, num_numa_nodes};
+    std::clog << "Solving..." << std::endl;
+    task::Runner runner{numa_affinity, settings.num_threads, [&](auto tc) {
+                            all_stats[static_cast<std::size_t>(tc.id())] =
+                                label_setting::run_thread(tc, pq, shared_data);
+                        }};
+    runner.wait();
+
+    if (label_out.is_open()) {
+        std::clog << "Writing labels..." << std::endl;
+        for (std::size_t i = 0; i < shared_data.labels.size(); ++i) {
+            label_out << i << ' ' << shared_data.labels[i].load() << '\n';
+        }
+        label_out.close();
+    }
+    std::clog << "Finished\n" << std::endl;
+    auto accum_stats =
+        std::accumulate(all_stats.begin() + 1, all_stats.end(), all_stats.front(), label_setting::accumulate);
+    auto time = std::chrono::duration<double>(accum_stats.work_time.second - accum_stats.work_time.first).count();
+    std::clog << "Time (s): " << std::setprecision(3) << time << '\n';
+    std::clog << "Pushed nodes: " << accum_stats.pushed_nodes << '\n';
+    std::clog << "Processed nodes: " << accum_stats.processed_nodes << '\n';
+    std::clog << "Ignored nodes: " << accum_stats.ignored_nodes << '\n';
+    if (accum_stats.processed_nodes + accum_stats.ignored_nodes != accum_stats.pushed_nodes) {
+        std::clog << "Error: " << accum_stats.pushed_nodes - (accum_stats.processed_nodes + accum_stats.ignored_nodes)
+                  << " node(s) were not popped" << std::endl;
+        return false;
+    }
+    if (!label_setting::verify(shared_data, numa_affinity, settings.num_threads)) {
+        std::clog << "Error: Invalid labels" << std::endl;
+        return false;
+    }
+    std::cout << "algebra,time,pushed,processed,ignored\n";
+    std::cout << algebra_type::name << ',' << time << ',' << accum_stats.pushed_nodes << ','
+              << accum_stats.processed_nodes << ',' << accum_stats.ignored_nodes << '\n';
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    write_build_info(std::clog);
+    std::clog << "\nCommand line:";
+    for (int i = 0; i < argc; ++i) {
+        std::clog << ' ' << argv[i];
+    }
+    std::clog << '\n' << '\n';
+
+    Settings settings{};
+    cxxopts::Options cmd(argv[0]);
+    // clang-format off
+    cmd.add_options()
+      ("j,threads", "The number of threads", cxxopts::value<int>(settings.num_threads), "NUMBER")
+      ("file", "The input graph", cxxopts::value<std::filesystem::path>(settings.graph_file), "PATH")
+      ("o,label-file", "Path to write the labels to", cxxopts::value<std::filesystem::path>(settings.label_file), "PATH")
+      ("h,help", "Print this help");
+    // clang-format on
+    add_options(cmd);
+    cmd.parse_positional({"file"});
+
+    auto args = cxxopts::ParseResult{};
+    try {
+        args = cmd.parse(argc, argv);
+        if (args.count("help") > 0) {
+            std::cerr << cmd.help() << std::endl;
+            return EXIT_SUCCESS;
+        }
+    } catch (cxxopts::OptionParseException const& e) {
+        std::cerr << "Error parsing arguments: " << e.what() << '\n';
+        std::cerr << cmd.help() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    write_settings(settings, std::clog);
+
+    auto pq = create<algebra_type::min_queue>(settings.num_threads, 1 << 24, args);
+    std::clog << "Priority queue: ";
+    describe(pq, std::clog) << '\n' << '\n';
+    bool success = run_benchmark(settings, pq);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
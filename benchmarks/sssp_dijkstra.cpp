@@ -1,8 +1,13 @@
 #include "build_info.hpp"
+#include "distance_file.hpp"
 #include "graph.hpp"
+#include "implicit_graph.hpp"
+#include "key_transform.hpp"
+#include "label_setting.hpp"
+#include "path_algebra.hpp"
+#include "simd_relaxation.hpp"
 #include "task.hpp"
 #include "termination_detection.hpp"
-#include "wrapper/priority.hpp"
 #include "wrapper/selector.hpp"
 
 #include "cxxopts.hpp"
@@ -12,12 +17,14 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <x86intrin.h>
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
 #include <charconv>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -26,7 +33,11 @@
 #include <memory>
 #include <new>
 #include <numeric>
+#include <optional>
+#include <queue>
 #include <random>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <type_traits>
 #include <utility>
@@ -42,115 +53,806 @@ static constexpr auto num_numa_nodes = NUM_NUMA_NODES;
 #else
 static constexpr auto num_numa_nodes = 16;
 #endif
-using pq_type = PriorityQueue<unsigned long, unsigned long, Priority::Min>;
+using pq_type = PQWrapper<true>;
 using handle_type = pq_type::handle_type;
+using local_queue_type = std::priority_queue<pq_type::value_type, std::vector<pq_type::value_type>, std::greater<>>;
+using algebra_type = path_algebra::ShortestPath;
 
 struct Settings {
     int num_threads = 4;
     std::filesystem::path graph_file;
+    std::string grid;
+    bool torus = false;
+    long long max_weight = 1000;
     std::filesystem::path distance_file;
+    bool binary_distances = false;
     int seed = 1;
-    pq_type::config_type pq_settings{};
+    bool track_queued_keys = false;
+    bool vectorized_relaxation = false;
+    std::size_t target = std::numeric_limits<std::size_t>::max();
+    bool bidirectional = false;
+    long long local_window = 0;
+    std::size_t local_capacity = 16;
+    std::size_t hub_degree = 0;
+    std::size_t hub_chunk_size = 1024;
+    unsigned int coarsen_shift = 0;
+    unsigned long coarsen_delta = 1;
+    int update_batches = 0;
+    std::size_t batch_size = 1000;
+
+    [[nodiscard]] key_transform::Coarsening coarsening() const {
+        return key_transform::Coarsening::from_options(coarsen_shift, coarsen_delta);
+    }
 };
 
 void write_settings(Settings const& settings, std::ostream& out) {
     out << "Threads: " << settings.num_threads << '\n'
-        << "Graph: " << settings.graph_file.string() << '\n'
-        << "Seed: " << settings.seed;
+        << "Graph: "
+        << (settings.grid.empty() ? settings.graph_file.string()
+                                  : settings.grid + (settings.torus ? " torus" : " grid") + " (implicit)")
+        << '\n'
+        << "Seed: " << settings.seed << '\n'
+        << "Track queued keys: " << std::boolalpha << settings.track_queued_keys << '\n'
+        << "Vectorized relaxation: " << settings.vectorized_relaxation << " (" << simd::lanes << " lanes)"
+        << std::noboolalpha;
+    out << '\n'
+        << "Key coarsening: " << settings.coarsening();
+    if (settings.local_window > 0) {
+        out << '\n'
+            << "Local queue window: " << settings.local_window << " (capacity " << settings.local_capacity << ')';
+    }
+    if (settings.hub_degree > 0) {
+        out << '\n'
+            << "Hub degree: " << settings.hub_degree << " (chunks of " << settings.hub_chunk_size << " edges)";
+    }
+    if (settings.target != std::numeric_limits<std::size_t>::max()) {
+        out << '\n' << "Target: " << settings.target << (settings.bidirectional ? " (bidirectional)" : "");
+    }
+    if (settings.update_batches > 0) {
+        out << '\n' << "Update batches: " << settings.update_batches << " (size " << settings.batch_size << ')';
+    }
     out << "\n\n";
 }
 
 struct ThreadStats {
-    std::pair<std::chrono::high_resolution_clock::time_point, std::chrono::high_resolution_clock::time_point> work_time;
-    long long pushed_nodes{0};
-    long long ignored_nodes{0};
-    long long processed_nodes{0};
+    label_setting::ThreadStats search;
+    long long avoided_pushes{0};
+    long long local_pushes{0};
+    // Hub chunks are also counted as pushed and processed nodes
+    long long pushed_chunks{0};
+    long long processed_chunks{0};
+    // Largest number of edges relaxed by a single thread
+    long long max_thread_relaxed_edges{0};
 };
 
-struct SharedData {
-    struct alignas(L1_CACHE_LINESIZE) AtomicDistance {
+static constexpr std::size_t no_target = std::numeric_limits<std::size_t>::max();
+// Marks elements of the backward search in bidirectional mode
+static constexpr unsigned long backward_tag = 1UL << 63;
+// Elements of the one-directional search store the adjacency chunk of split hubs above the node id, 0 denotes the
+// whole node
+static constexpr unsigned int chunk_shift = 40;
+static constexpr unsigned long node_mask = (1UL << chunk_shift) - 1;
+static constexpr unsigned long max_hub_chunks = 1UL << (64 - chunk_shift);
+
+// Per-node state of searches on graph files, the queued key and the backward label share the cache line with the
+// distance
+class NodeLabels {
+    struct alignas(L1_CACHE_LINESIZE) Entry {
         std::atomic<long long> value{std::numeric_limits<long long>::max()};
+        // Smallest key this node was ever pushed with
+        std::atomic<long long> queued_key{std::numeric_limits<long long>::max()};
+        // Distance to the target in bidirectional searches
+        std::atomic<long long> backward_value{std::numeric_limits<long long>::max()};
     };
-    Graph graph;
-    std::vector<AtomicDistance> shortest_distances;
-    termination_detection::Data termination_detection_data{};
 
-    SharedData(std::size_t num_nodes) : shortest_distances(num_nodes) {
+    std::vector<Entry> entries_;
+
+   public:
+    // The distance of node `i` is at `data()[i * stride]`
+    static constexpr std::size_t stride = sizeof(Entry) / sizeof(long long);
+
+    explicit NodeLabels(std::size_t num_nodes) : entries_(num_nodes) {
+    }
+
+    std::atomic<long long>& operator[](std::size_t i) noexcept {
+        return entries_[i].value;
+    }
+
+    std::atomic<long long> const& operator[](std::size_t i) const noexcept {
+        return entries_[i].value;
     }
 
-    bool update_distance(std::size_t index, long long current, long long target) noexcept {
-        while (target < current) {
-            if (shortest_distances[index].value.compare_exchange_weak(current, target, std::memory_order_relaxed)) {
+    std::atomic<long long>& queued_key(std::size_t i) noexcept {
+        return entries_[i].queued_key;
+    }
+
+    std::atomic<long long>& backward(std::size_t i) noexcept {
+        return entries_[i].backward_value;
+    }
+
+    [[nodiscard]] long long const* data() const noexcept {
+        return reinterpret_cast<long long const*>(entries_.data());
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return entries_.size();
+    }
+
+    [[nodiscard]] std::size_t bytes_per_node() const noexcept {
+        return sizeof(Entry);
+    }
+};
+
+// Per-node state of searches on implicit graphs, which only need the distances. These are stored without padding,
+// so that graphs with billions of nodes fit into memory. Queued keys are kept in a second array if enabled.
+class CompactLabels {
+    struct Label {
+        std::atomic<long long> value{std::numeric_limits<long long>::max()};
+    };
+
+    std::vector<Label> values_;
+    std::vector<Label> queued_keys_;
+
+   public:
+    explicit CompactLabels(std::size_t num_nodes) : values_(num_nodes) {
+    }
+
+    void enable_queued_keys() {
+        queued_keys_ = std::vector<Label>(values_.size());
+    }
+
+    std::atomic<long long>& operator[](std::size_t i) noexcept {
+        return values_[i].value;
+    }
+
+    std::atomic<long long> const& operator[](std::size_t i) const noexcept {
+        return values_[i].value;
+    }
+
+    std::atomic<long long>& queued_key(std::size_t i) noexcept {
+        assert(!queued_keys_.empty());
+        return queued_keys_[i].value;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return values_.size();
+    }
+
+    [[nodiscard]] std::size_t bytes_per_node() const noexcept {
+        return sizeof(Label) * (queued_keys_.empty() ? 1 : 2);
+    }
+};
+
+// Modes of the one-directional search, implemented by SearchHooks
+struct SearchOptions {
+    bool track_queued_keys = false;
+    bool vectorized_relaxation = false;
+    std::size_t target_node = no_target;
+    // Pushes with keys at most this much larger than the current key go to the thread's local queue, 0 disables it
+    long long local_window = 0;
+    std::size_t local_capacity = 0;
+    // Nodes with more edges are relaxed in chunks of `hub_chunk_size` edges by different threads, 0 disables it
+    std::size_t hub_degree = 0;
+    std::size_t hub_chunk_size = 0;
+    // Nodes are pushed with coarsened distances as keys and processed with their current distance
+    key_transform::Coarsening coarsening{};
+};
+
+template <typename GraphType, typename Labels>
+struct SharedData {
+    label_setting::SharedData<algebra_type, GraphType, Labels> search;
+    SearchOptions options;
+    Graph reverse_graph;
+    bool bidirectional = false;
+    alignas(L1_CACHE_LINESIZE) std::atomic<long long> best_meeting_distance{std::numeric_limits<long long>::max()};
+
+    explicit SharedData(GraphType const& graph) : search{graph} {
+    }
+
+    // Sequentially consistent, so that when both searches label the same node, at least one sees the other's label
+    static bool update_label(std::atomic<long long>& label, long long current, long long update) noexcept {
+        while (update < current) {
+            if (label.compare_exchange_weak(current, update)) {
                 return true;
             }
         }
         return false;
     }
+
+    void update_meeting_distance(long long distance) noexcept {
+        auto current = best_meeting_distance.load(std::memory_order_relaxed);
+        while (distance < current &&
+               !best_meeting_distance.compare_exchange_weak(current, distance, std::memory_order_relaxed)) {
+        }
+    }
 };
 
-bool process_node(handle_type& handle, ThreadStats& stats, SharedData& data) {
+// Returns false if an entry with a key at most `key` is already queued, in which case pushing is redundant. Sequentially
+// consistent, so that it is ordered after the distance update.
+template <typename Labels>
+bool update_queued_key(Labels& labels, std::size_t index, long long key) noexcept {
+    auto current = labels.queued_key(index).load();
+    while (key < current) {
+        if (labels.queued_key(index).compare_exchange_weak(current, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Called when an entry with `key` is popped, before reading the node's distance. With coarsened keys, later
+// improvements can map to the same key and must be pushed again.
+template <typename Labels>
+void reset_queued_key(Labels& labels, std::size_t index, long long key) noexcept {
+    labels.queued_key(index).compare_exchange_strong(key, std::numeric_limits<long long>::max());
+}
+
+// Hooks of the one-directional search into label_setting::process_node, each thread owns its own
+template <typename Labels>
+class SearchHooks {
+    SearchOptions const& options_;
+    Labels& labels_;
+    ThreadStats& stats_;
+    local_queue_type local_queue_;
+
+    static std::size_t chunk(pq_type::value_type const& entry) noexcept {
+        return static_cast<std::size_t>(entry.second >> chunk_shift);
+    }
+
+   public:
+    SearchHooks(SearchOptions const& options, Labels& labels, ThreadStats& stats)
+        : options_{options}, labels_{labels}, stats_{stats} {
+    }
+
+    std::optional<pq_type::value_type> pop(handle_type& handle) {
+        if (!local_queue_.empty()) {
+            auto entry = local_queue_.top();
+            local_queue_.pop();
+            return entry;
+        }
+        return handle.try_pop();
+    }
+
+    static std::size_t node(pq_type::value_type const& entry) noexcept {
+        return static_cast<std::size_t>(entry.second & node_mask);
+    }
+
+    void popped(pq_type::value_type const& entry) noexcept {
+        if (options_.track_queued_keys && chunk(entry) == 0) {
+            reset_queued_key(labels_, node(entry), static_cast<long long>(entry.first));
+        }
+    }
+
+    bool stale(pq_type::value_type const& entry, long long distance) const noexcept {
+        // Nodes at least as far as the target cannot lead to a shorter path to it
+        return entry.first > options_.coarsening(static_cast<unsigned long>(distance)) ||
+            (options_.target_node != no_target &&
+             distance >= labels_[options_.target_node].load(std::memory_order_relaxed));
+    }
+
+    template <typename GraphType, typename Relax>
+    void relax_edges(GraphType const& graph, handle_type& handle, pq_type::value_type const& entry, long long distance,
+                     label_setting::ThreadStats& stats, Relax&& relax) {
+        auto id = node(entry);
+        auto c = chunk(entry);
+        if (c != 0) {
+            ++stats_.processed_chunks;
+        }
+        if constexpr (std::is_same_v<GraphType, Graph>) {
+            auto begin = graph.nodes[id];
+            auto end = graph.nodes[id + 1];
+            if (options_.hub_degree > 0 && end - begin > options_.hub_degree) {
+                // The thread popping a hub relaxes its first chunk and leaves the others to whoever pops them
+                if (c == 0) {
+                    auto num_chunks = (end - begin + options_.hub_chunk_size - 1) / options_.hub_chunk_size;
+                    for (std::size_t i = 1; i < num_chunks; ++i) {
+                        handle.push({entry.first, id | (static_cast<unsigned long>(i) << chunk_shift)});
+                    }
+                    stats.pushed_nodes += static_cast<long long>(num_chunks - 1);
+                    stats_.pushed_chunks += static_cast<long long>(num_chunks - 1);
+                }
+                begin += c * options_.hub_chunk_size;
+                end = std::min(end, begin + options_.hub_chunk_size);
+            }
+            stats.relaxed_edges += static_cast<long long>(end - begin);
+            if (options_.vectorized_relaxation) {
+                // Plain loads of the atomic distances, relax() rechecks atomically
+                simd::relax_edges<Labels::stride>(graph, begin, end, distance, labels_.data(), relax);
+            } else {
+                for (auto i = begin; i < end; ++i) {
+                    relax(graph.edges[i].target, distance + graph.edges[i].weight);
+                }
+            }
+        } else {
+            graph.for_each_edge(id, [&](std::size_t target, long long weight) {
+                ++stats.relaxed_edges;
+                relax(target, distance + weight);
+            });
+        }
+    }
+
+    void push(handle_type& handle, std::size_t target, long long distance, long long new_distance,
+              label_setting::ThreadStats& stats) {
+        auto key = options_.coarsening(static_cast<unsigned long>(new_distance));
+        if (options_.track_queued_keys && !update_queued_key(labels_, target, static_cast<long long>(key))) {
+            ++stats_.avoided_pushes;
+            return;
+        }
+        if (new_distance - distance <= options_.local_window && local_queue_.size() < options_.local_capacity) {
+            local_queue_.push({key, target});
+            ++stats_.local_pushes;
+        } else {
+            handle.push({key, target});
+        }
+        ++stats.pushed_nodes;
+    }
+};
+
+// Forward and backward search share the queue. A shortest path of length L has an edge (u, v) with
+// d(s, u) <= L / 2 and d(v, t) < L / 2, so nodes with twice their key at least the best meeting distance are pruned.
+bool process_node_bidirectional(handle_type& handle, label_setting::ThreadStats& stats,
+                                SharedData<Graph, NodeLabels>& data) {
     auto node = handle.try_pop();
     if (!node) {
         return false;
     }
-    auto current_distance = data.shortest_distances[node->second].value.load(std::memory_order_relaxed);
-    if (static_cast<long long>(node->first) > current_distance) {
+    bool backward = (node->second & backward_tag) != 0;
+    auto id = static_cast<std::size_t>(node->second & ~backward_tag);
+    auto distance = static_cast<long long>(node->first);
+    auto& labels = data.search.labels;
+    auto label = [&](std::size_t i) -> std::atomic<long long>& { return backward ? labels.backward(i) : labels[i]; };
+    auto other_label = [&](std::size_t i) -> std::atomic<long long>& {
+        return backward ? labels[i] : labels.backward(i);
+    };
+    if (distance > label(id).load(std::memory_order_relaxed) ||
+        2 * distance >= data.best_meeting_distance.load(std::memory_order_relaxed)) {
         ++stats.ignored_nodes;
         return true;
     }
     ++stats.processed_nodes;
-    for (auto i = data.graph.nodes[node->second]; i < data.graph.nodes[node->second + 1]; ++i) {
-        auto target = data.graph.edges[i].target;
-        auto d = static_cast<long long>(node->first) + data.graph.edges[i].weight;
-        auto old_d = data.shortest_distances[target].value.load(std::memory_order_relaxed);
-        if (data.update_distance(target, old_d, d)) {
-            handle.push({d, target});
+    auto const& graph = backward ? data.reverse_graph : data.search.graph;
+    stats.relaxed_edges += static_cast<long long>(graph.nodes[id + 1] - graph.nodes[id]);
+    for (auto i = graph.nodes[id]; i < graph.nodes[id + 1]; ++i) {
+        auto target = graph.edges[i].target;
+        auto d = distance + graph.edges[i].weight;
+        auto& target_label = label(target);
+        if (!data.update_label(target_label, target_label.load(std::memory_order_relaxed), d)) {
+            continue;
+        }
+        auto other_d = other_label(target).load();
+        if (other_d != std::numeric_limits<long long>::max()) {
+            data.update_meeting_distance(d + other_d);
+        }
+        if (2 * d < data.best_meeting_distance.load(std::memory_order_relaxed)) {
+            handle.push({d, backward ? target | backward_tag : target});
             ++stats.pushed_nodes;
         }
     }
     return true;
 }
 
-ThreadStats benchmark_thread(task::Control tc, pq_type& pq, SharedData& data) {
-    ThreadStats stats;
-    auto handle = pq.get_handle();
-    if (tc.id() == 0) {
-        data.shortest_distances[0].value = 0;
-        handle.push({0, 0});
-        ++stats.pushed_nodes;
+long long popped_elements(ThreadStats const& stats) {
+    return stats.search.processed_nodes + stats.search.ignored_nodes;
+}
+
+// Ratio of the most edges relaxed by a thread to the average, 1 is perfect balance
+double load_imbalance(ThreadStats const& stats, int num_threads) {
+    if (stats.search.relaxed_edges == 0) {
+        return 1.0;
+    }
+    return static_cast<double>(stats.max_thread_relaxed_edges) * num_threads /
+        static_cast<double>(stats.search.relaxed_edges);
+}
+
+void write_stats(ThreadStats const& stats, int num_threads, std::ostream& out) {
+    std::cout << "time,pushed,processed,ignored,avoided,local,chunks,relaxed,imbalance\n";
+    out << (stats.search.work_time.second - stats.search.work_time.first).count() << ',' << stats.search.pushed_nodes
+        << ',' << stats.search.processed_nodes - stats.processed_chunks << ',' << stats.search.ignored_nodes << ','
+        << stats.avoided_pushes << ',' << stats.local_pushes << ',' << stats.pushed_chunks << ','
+        << stats.search.relaxed_edges << ',' << load_imbalance(stats, num_threads) << '\n';
+}
+
+ThreadStats accumulate_stats(std::vector<ThreadStats> const& all_stats) {
+    return std::accumulate(all_stats.begin() + 1, all_stats.end(), all_stats.front(), [](auto accum, auto const& e) {
+        accum.search = label_setting::accumulate(accum.search, e.search);
+        accum.avoided_pushes += e.avoided_pushes;
+        accum.local_pushes += e.local_pushes;
+        accum.pushed_chunks += e.pushed_chunks;
+        accum.processed_chunks += e.processed_chunks;
+        accum.max_thread_relaxed_edges = std::max(accum.max_thread_relaxed_edges, e.max_thread_relaxed_edges);
+        return accum;
+    });
+}
+
+// Runs `work(tc, stats)` on all threads and accumulates their stats
+template <typename Work>
+ThreadStats run_workers(int num_threads, termination_detection::Data& termination_detection_data, Work work) {
+    termination_detection_data.idle_count = 0;
+    termination_detection_data.no_work_count = 0;
+    std::vector<ThreadStats> all_stats(static_cast<std::size_t>(num_threads));
+    affinity::NUMA numa_affinity{cores_per_numa_node, num_numa_nodes};
+    task::Runner runner{numa_affinity, num_threads, [&](auto tc) {
+                            auto& stats = all_stats[static_cast<std::size_t>(tc.id())];
+                            work(tc, stats);
+                            stats.max_thread_relaxed_edges = stats.search.relaxed_edges;
+                        }};
+    runner.wait();
+    return accumulate_stats(all_stats);
+}
+
+// Runs the one-directional search until no entries are left, starting from `entries`
+template <typename GraphType, typename Labels>
+ThreadStats solve(pq_type& pq, int num_threads, SharedData<GraphType, Labels>& data,
+                  std::vector<pq_type::value_type> const& entries) {
+    return run_workers(num_threads, data.search.termination_detection_data, [&](auto tc, ThreadStats& stats) {
+        SearchHooks<Labels> hooks{data.options, data.search.labels, stats};
+        stats.search = label_setting::run_thread(tc, pq, data.search, hooks, entries);
+    });
+}
+
+// Labels the source node and returns its queue entry
+template <typename GraphType, typename Labels>
+std::vector<pq_type::value_type> initial_entries(SharedData<GraphType, Labels>& data) {
+    data.search.labels[0] = 0;
+    if (data.options.track_queued_keys) {
+        data.search.labels.queued_key(0) = 0;
+    }
+    return {pq_type::value_type{0, 0}};
+}
+
+ThreadStats solve_bidirectional(pq_type& pq, int num_threads, SharedData<Graph, NodeLabels>& data) {
+    auto target = data.options.target_node;
+    data.search.labels[0] = 0;
+    data.search.labels.backward(target) = 0;
+    if (target == 0) {
+        data.best_meeting_distance = 0;
+    }
+    return run_workers(num_threads, data.search.termination_detection_data, [&](auto tc, ThreadStats& stats) {
+        handle_type handle = pq.get_handle();
+        if (tc.id() == 0) {
+            handle.push({0, 0});
+            handle.push({0, target | backward_tag});
+            stats.search.pushed_nodes += 2;
+        }
+        tc.synchronize();
+        auto start_time = std::chrono::steady_clock::now();
+        while (termination_detection::try_do(tc.num_threads(), data.search.termination_detection_data, [&]() {
+            return process_node_bidirectional(handle, stats.search, data);
+        })) {
+        }
+        auto end_time = std::chrono::steady_clock::now();
+        tc.synchronize();
+        stats.search.work_time = {start_time, end_time};
+    });
+}
+
+// Runs the search from the start node(s)
+template <typename GraphType, typename Labels>
+ThreadStats solve_from_source(pq_type& pq, int num_threads, SharedData<GraphType, Labels>& data) {
+    if constexpr (std::is_same_v<SharedData<GraphType, Labels>, SharedData<Graph, NodeLabels>>) {
+        if (data.bidirectional) {
+            return solve_bidirectional(pq, num_threads, data);
+        }
     }
-    tc.synchronize();
-    auto start_time = std::chrono::high_resolution_clock::now();
-    while (termination_detection::try_do(tc.num_threads(), data.termination_detection_data,
-                                         [&]() { return process_node(handle, stats, data); })) {
+    return solve(pq, num_threads, data, initial_entries(data));
+}
+
+struct WeightUpdate {
+    std::size_t source;
+    std::size_t edge;
+    Graph::weight_type old_weight;
+    Graph::weight_type new_weight;
+};
+
+using file_data_type = SharedData<Graph, NodeLabels>;
+
+// Sets up to `batch_size` distinct random edges of `graph` to random weights between 1 and twice their old weight and
+// returns the changes
+std::vector<WeightUpdate> apply_random_updates(Graph& graph, Graph& reverse_graph, std::size_t batch_size,
+                                               std::mt19937_64& rng) {
+    std::uniform_int_distribution<std::size_t> edge_dist(0, graph.num_edges() - 1);
+    std::vector<std::size_t> edges(batch_size);
+    std::generate(edges.begin(), edges.end(), [&]() { return edge_dist(rng); });
+    // An edge changed twice would hide its original weight from the repair
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    std::vector<WeightUpdate> updates;
+    updates.reserve(edges.size());
+    for (auto edge : edges) {
+        auto source = graph.source(edge);
+        auto target = graph.edges[edge].target;
+        auto old_weight = graph.edges[edge].weight;
+        auto new_weight = std::uniform_int_distribution<Graph::weight_type>(1, std::max(2 * old_weight, 1LL))(rng);
+        auto reverse_edge = reverse_graph.find_edge(target, source, old_weight);
+        assert(reverse_edge < reverse_graph.num_edges());
+        graph.set_weight(edge, new_weight);
+        reverse_graph.set_weight(reverse_edge, new_weight);
+        updates.push_back({source, edge, old_weight, new_weight});
     }
-    auto end_time = std::chrono::high_resolution_clock::now();
-    tc.synchronize();
-    stats.work_time = {start_time, end_time};
-    return stats;
+    return updates;
 }
 
-void write_stats(ThreadStats const& stats, std::ostream& out) {
-    std::cout << "time,pushed,processed,ignored\n";
-    out << (stats.work_time.second - stats.work_time.first).count() << ',' << stats.pushed_nodes << ','
-        << stats.processed_nodes << ',' << stats.ignored_nodes << '\n';
+// Ramalingam-Reps: a node is affected by the weight changes if none of its shortest paths is left, i.e. it has no
+// tight incoming edge from an unaffected node under the new weights. Candidates are the targets of changed edges that
+// were tight before, since a decreased edge can lose its tightness when its source is affected, and the tight
+// successors of affected nodes. They are classified in order of their old distance, so with positive weights all their
+// tight predecessors are already classified. Marks the affected nodes in `affected` and returns them.
+std::vector<std::size_t> find_affected_nodes(file_data_type const& data, std::vector<WeightUpdate> const& updates,
+                                             std::vector<char>& affected) {
+    using candidate_type = std::pair<long long, std::size_t>;
+    constexpr auto infinity = std::numeric_limits<long long>::max();
+    auto const& graph = data.search.graph;
+    auto distance = [&](std::size_t node) { return data.search.labels[node].load(std::memory_order_relaxed); };
+    std::priority_queue<candidate_type, std::vector<candidate_type>, std::greater<>> candidates;
+    for (auto const& update : updates) {
+        auto target = graph.edges[update.edge].target;
+        if (update.new_weight != update.old_weight && distance(update.source) != infinity &&
+            distance(update.source) + update.old_weight == distance(target)) {
+            candidates.push({distance(target), target});
+        }
+    }
+    std::vector<std::size_t> affected_nodes;
+    while (!candidates.empty()) {
+        auto [d, node] = candidates.top();
+        candidates.pop();
+        if (affected[node] != 0) {
+            continue;
+        }
+        auto const& reverse = data.reverse_graph;
+        bool has_shortest_path = false;
+        for (auto i = reverse.nodes[node]; i < reverse.nodes[node + 1]; ++i) {
+            auto predecessor = reverse.edges[i].target;
+            if (affected[predecessor] == 0 && distance(predecessor) != infinity &&
+                distance(predecessor) + reverse.edges[i].weight == d) {
+                has_shortest_path = true;
+                break;
+            }
+        }
+        if (has_shortest_path) {
+            continue;
+        }
+        affected[node] = 1;
+        affected_nodes.push_back(node);
+        for (auto i = graph.nodes[node]; i < graph.nodes[node + 1]; ++i) {
+            auto target = graph.edges[i].target;
+            if (affected[target] == 0 && d + graph.edges[i].weight == distance(target)) {
+                candidates.push({distance(target), target});
+            }
+        }
+    }
+    return affected_nodes;
+}
+
+// Resets the affected nodes to their best distance over unaffected predecessors and applies the weight decreases.
+// Returns the queue entries of all changed nodes, from which the workers restart the relaxation.
+std::vector<pq_type::value_type> repair_entries(file_data_type& data, std::vector<WeightUpdate> const& updates,
+                                                std::vector<std::size_t> const& affected_nodes,
+                                                std::vector<char> const& affected) {
+    constexpr auto infinity = std::numeric_limits<long long>::max();
+    auto& labels = data.search.labels;
+    std::vector<pq_type::value_type> entries;
+    auto relax = [&](std::size_t node, long long d) {
+        if (!data.search.update_label(node, labels[node].load(std::memory_order_relaxed), d)) {
+            return;
+        }
+        auto key = data.options.coarsening(static_cast<unsigned long>(d));
+        if (data.options.track_queued_keys) {
+            update_queued_key(labels, node, static_cast<long long>(key));
+        }
+        entries.push_back({key, node});
+    };
+    for (auto node : affected_nodes) {
+        labels[node].store(infinity, std::memory_order_relaxed);
+    }
+    for (auto node : affected_nodes) {
+        auto const& reverse = data.reverse_graph;
+        auto best = infinity;
+        for (auto i = reverse.nodes[node]; i < reverse.nodes[node + 1]; ++i) {
+            auto predecessor = reverse.edges[i].target;
+            auto d = labels[predecessor].load(std::memory_order_relaxed);
+            if (affected[predecessor] == 0 && d != infinity) {
+                best = std::min(best, d + reverse.edges[i].weight);
+            }
+        }
+        if (best != infinity) {
+            relax(node, best);
+        }
+    }
+    for (auto const& update : updates) {
+        auto d = labels[update.source].load(std::memory_order_relaxed);
+        if (update.new_weight < update.old_weight && d != infinity) {
+            relax(data.search.graph.edges[update.edge].target, d + update.new_weight);
+        }
+    }
+    return entries;
 }
 
-bool verify_distances(SharedData const& shared_data) {
-    for (std::size_t i = 0; i < shared_data.graph.num_nodes(); ++i) {
-        for (std::size_t j = shared_data.graph.nodes[i]; j < shared_data.graph.nodes[i + 1]; ++j) {
-            auto d = shared_data.shortest_distances[i].value + shared_data.graph.edges[j].weight;
-            if (d < shared_data.shortest_distances[shared_data.graph.edges[j].target].value) {
+// Applies batches of weight updates to `graph`, repairs the distances and compares each repair with a full recompute
+bool run_updates(Settings const& settings, cxxopts::ParseResult const& args, Graph& graph,
+                 file_data_type& shared_data) {
+    std::clog << "Building reverse graph..." << std::endl;
+    shared_data.reverse_graph = graph.reversed();
+    auto& labels = shared_data.search.labels;
+    std::mt19937_64 rng(static_cast<std::mt19937_64::result_type>(settings.seed));
+    std::vector<char> affected(graph.num_nodes(), 0);
+    std::vector<long long> repaired_distances(graph.num_nodes());
+    std::clog << "Applying updates..." << std::endl;
+    std::cout << "batch,increases,decreases,affected,repair_time,repair_processed,recompute_time,recompute_processed\n";
+    for (int batch = 0; batch < settings.update_batches; ++batch) {
+        auto updates = apply_random_updates(graph, shared_data.reverse_graph, settings.batch_size, rng);
+        auto num_increases =
+            std::count_if(updates.begin(), updates.end(), [](auto const& u) { return u.new_weight > u.old_weight; });
+        auto num_decreases =
+            std::count_if(updates.begin(), updates.end(), [](auto const& u) { return u.new_weight < u.old_weight; });
+
+        auto repair_start = std::chrono::high_resolution_clock::now();
+        auto affected_nodes = find_affected_nodes(shared_data, updates, affected);
+        auto entries = repair_entries(shared_data, updates, affected_nodes, affected);
+        auto repair_pq = create<true>(settings.num_threads, graph.num_nodes(), args);
+        auto repair_stats = solve(repair_pq, settings.num_threads, shared_data, entries);
+        auto repair_end = std::chrono::high_resolution_clock::now();
+        for (auto node : affected_nodes) {
+            affected[node] = 0;
+        }
+        if (popped_elements(repair_stats) != repair_stats.search.pushed_nodes) {
+            std::clog << "Error: Nodes were not popped in batch " << batch << std::endl;
+            return false;
+        }
+
+        for (std::size_t i = 0; i < repaired_distances.size(); ++i) {
+            repaired_distances[i] = labels[i].load(std::memory_order_relaxed);
+            labels[i].store(std::numeric_limits<long long>::max(), std::memory_order_relaxed);
+            labels.queued_key(i).store(std::numeric_limits<long long>::max(), std::memory_order_relaxed);
+        }
+        auto recompute_start = std::chrono::high_resolution_clock::now();
+        auto recompute_pq = create<true>(settings.num_threads, graph.num_nodes(), args);
+        auto recompute_stats = solve_from_source(recompute_pq, settings.num_threads, shared_data);
+        auto recompute_end = std::chrono::high_resolution_clock::now();
+        for (std::size_t i = 0; i < repaired_distances.size(); ++i) {
+            if (repaired_distances[i] != labels[i].load(std::memory_order_relaxed)) {
+                std::clog << "Error: Repaired distance of node " << i << " differs from the recomputed distance"
+                          << std::endl;
                 return false;
             }
         }
+        std::cout << batch << ',' << num_increases << ',' << num_decreases << ',' << affected_nodes.size() << ','
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(repair_end - repair_start).count() << ','
+                  << repair_stats.search.processed_nodes - repair_stats.processed_chunks << ','
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(recompute_end - recompute_start).count()
+                  << ',' << recompute_stats.search.processed_nodes - recompute_stats.processed_chunks << '\n';
     }
     return true;
 }
 
-bool run_benchmark(Settings const& settings) {
+// Configures the search modes, solves from node 0, writes the distances and checks them
+template <typename GraphType, typename Labels>
+bool run_search(Settings const& settings, cxxopts::ParseResult const& args, SharedData<GraphType, Labels>& shared_data,
+                std::ofstream& distance_out) {
+    auto& labels = shared_data.search.labels;
+    auto& options = shared_data.options;
+    options.track_queued_keys = settings.track_queued_keys;
+    if constexpr (std::is_same_v<Labels, CompactLabels>) {
+        if (settings.track_queued_keys) {
+            labels.enable_queued_keys();
+        }
+    }
+    options.vectorized_relaxation = settings.vectorized_relaxation;
+    options.coarsening = settings.coarsening();
+    if (settings.local_window > 0) {
+        options.local_window = settings.local_window;
+        options.local_capacity = settings.local_capacity;
+    }
+    if (settings.target != no_target) {
+        if (settings.target >= labels.size()) {
+            std::clog << "Error: Invalid target node" << std::endl;
+            return false;
+        }
+        options.target_node = settings.target;
+    }
+    if (settings.hub_degree > 0) {
+        if (settings.hub_chunk_size == 0) {
+            std::clog << "Error: Hub chunks must not be empty" << std::endl;
+            return false;
+        }
+        if (labels.size() > node_mask) {
+            std::clog << "Error: Too many nodes to split hubs" << std::endl;
+            return false;
+        }
+        if constexpr (std::is_same_v<GraphType, Graph>) {
+            auto const& nodes = shared_data.search.graph.nodes;
+            std::size_t max_degree = 0;
+            for (std::size_t i = 0; i + 1 < nodes.size(); ++i) {
+                max_degree = std::max(max_degree, nodes[i + 1] - nodes[i]);
+            }
+            // The last chunk index of the largest hub must fit above the node id
+            if (max_degree > 0 && (max_degree - 1) / settings.hub_chunk_size >= max_hub_chunks) {
+                std::clog << "Error: Hub chunks too small for the maximum degree of " << max_degree << std::endl;
+                return false;
+            }
+        }
+        options.hub_degree = settings.hub_degree;
+        options.hub_chunk_size = settings.hub_chunk_size;
+    }
+    if constexpr (std::is_same_v<SharedData<GraphType, Labels>, file_data_type>) {
+        if (settings.bidirectional) {
+            if (options.coarsening.enabled()) {
+                std::clog << "Error: Bidirectional search requires exact keys" << std::endl;
+                return false;
+            }
+            std::clog << "Building reverse graph..." << std::endl;
+            shared_data.reverse_graph = shared_data.search.graph.reversed();
+            shared_data.bidirectional = true;
+        }
+    }
+
+    std::clog << "Label storage: " << labels.bytes_per_node() << " bytes per node" << std::endl;
+    auto pq = create<true>(settings.num_threads, labels.size(), args);
+    std::clog << "Priority queue: ";
+    describe(pq, std::clog) << '\n';
+    std::clog << "Solving..." << std::endl;
+    auto accum_stats = solve_from_source(pq, settings.num_threads, shared_data);
+
+    if (distance_out.is_open()) {
+        std::clog << "Writing distances..." << std::endl;
+        for (std::size_t i = 0; i < labels.size(); ++i) {
+            distance_out << i << ' ' << labels[i].load(std::memory_order_relaxed) << '\n';
+        }
+        distance_out.close();
+    } else if (!settings.distance_file.empty()) {
+        std::clog << "Writing distances..." << std::endl;
+        try {
+            distance_file::write_binary(settings.distance_file, labels.size(), [&](std::size_t i) {
+                return labels[i].load(std::memory_order_relaxed);
+            });
+        } catch (std::runtime_error const& e) {
+            std::cerr << "Error writing " << settings.distance_file << ": " << e.what() << std::endl;
+            return false;
+        }
+    }
+    std::clog << "Finished\n" << std::endl;
+    auto const& search_stats = accum_stats.search;
+    auto time = std::chrono::duration<double>(search_stats.work_time.second - search_stats.work_time.first).count();
+    std::clog << "Time (s): " << std::setprecision(3) << time << '\n';
+    std::clog << "Pops per second: " << static_cast<double>(popped_elements(accum_stats)) / time << '\n';
+    std::clog << "Pushed nodes: " << search_stats.pushed_nodes << '\n';
+    std::clog << "Processed nodes: " << search_stats.processed_nodes - accum_stats.processed_chunks << '\n';
+    std::clog << "Ignored nodes: " << search_stats.ignored_nodes << '\n';
+    if (settings.track_queued_keys) {
+        std::clog << "Avoided pushes: " << accum_stats.avoided_pushes << '\n';
+    }
+    if (settings.local_window > 0) {
+        std::clog << "Local pushes: " << accum_stats.local_pushes << '\n';
+    }
+    if (settings.hub_degree > 0) {
+        std::clog << "Pushed hub chunks: " << accum_stats.pushed_chunks << '\n';
+        std::clog << "Processed hub chunks: " << accum_stats.processed_chunks << '\n';
+    }
+    std::clog << "Relaxed edges: " << search_stats.relaxed_edges << '\n';
+    std::clog << "Load imbalance (max/avg relaxed edges): " << load_imbalance(accum_stats, settings.num_threads)
+              << '\n';
+    if (popped_elements(accum_stats) != search_stats.pushed_nodes) {
+        std::clog << "Error: " << search_stats.pushed_nodes - popped_elements(accum_stats)
+                  << " element(s) were not popped" << std::endl;
+        return false;
+    }
+    if (options.target_node != no_target) {
+        // Only the target distance is exact, so there is nothing to verify
+        std::clog << "Distance: "
+                  << (shared_data.bidirectional ? shared_data.best_meeting_distance.load()
+                                                : labels[options.target_node].load())
+                  << '\n';
+    } else if (!label_setting::verify(shared_data.search, affinity::NUMA{cores_per_numa_node, num_numa_nodes},
+                                      settings.num_threads)) {
+        std::clog << "Error: Invalid distances" << std::endl;
+        return false;
+    }
+    write_stats(accum_stats, settings.num_threads, std::cout);
+    return true;
+}
+
+bool run_benchmark(Settings const& settings, cxxopts::ParseResult const& args) {
     std::ofstream distance_out;
-    if (!settings.distance_file.empty()) {
+    if (!settings.distance_file.empty() && !settings.binary_distances) {
         distance_out = std::ofstream(settings.distance_file);
         if (!distance_out) {
             std::cerr << "Error: Could not open file " << settings.distance_file << " for writing" << std::endl;
@@ -158,6 +860,41 @@ bool run_benchmark(Settings const& settings) {
         }
     }
 
+    if (settings.bidirectional) {
+        if (settings.target == no_target) {
+            std::clog << "Error: Bidirectional search requires a target node" << std::endl;
+            return false;
+        }
+        if (settings.track_queued_keys || settings.local_window > 0 || settings.hub_degree > 0 ||
+            settings.vectorized_relaxation) {
+            std::clog << "Error: Bidirectional search supports neither queued keys, local queues, hub splitting nor "
+                         "vectorized relaxation"
+                      << std::endl;
+            return false;
+        }
+    }
+
+    if (!settings.grid.empty()) {
+        if (settings.vectorized_relaxation || settings.bidirectional || settings.update_batches > 0 ||
+            settings.hub_degree > 0 || args.count("hub-chunk") > 0) {
+            std::clog << "Error: Implicit graphs support neither vectorized relaxation, bidirectional search, weight "
+                         "updates nor hub splitting"
+                      << std::endl;
+            return false;
+        }
+        std::optional<GridGraph> implicit_graph;
+        try {
+            implicit_graph.emplace(GridGraph::parse_extent(settings.grid), settings.torus, settings.max_weight,
+                                   static_cast<std::uint64_t>(settings.seed));
+        } catch (std::runtime_error const& e) {
+            std::clog << "Error: " << e.what() << std::endl;
+            return false;
+        }
+        std::clog << "Implicit graph: " << *implicit_graph << std::endl;
+        SharedData<GridGraph, CompactLabels> shared_data{*implicit_graph};
+        return run_search(settings, args, shared_data, distance_out);
+    }
+
     std::clog << "Reading graph..." << std::endl;
     Graph graph;
     try {
@@ -166,53 +903,27 @@ bool run_benchmark(Settings const& settings) {
         std::clog << "Error: " << e.what() << std::endl;
         return false;
     }
-    SharedData shared_data{graph.num_nodes()};
-    shared_data.graph = std::move(graph);
-
-    auto pq = pq_type(settings.num_threads, shared_data.graph.num_nodes(), settings.pq_settings);
-    std::clog << "Priority queue: ";
-    pq.describe(std::clog) << '\n';
-    std::vector<ThreadStats> all_stats(static_cast<std::size_t>(settings.num_threads));
-    affinity::NUMA numa_affinity{cores_per_numa_node, num_numa_nodes};
-    std::clog << "Solving..." << std::endl;
-    task::Runner runner{numa_affinity, settings.num_threads, [&](auto tc) {
-                            all_stats[static_cast<std::size_t>(tc.id())] = benchmark_thread(tc, pq, shared_data);
-                        }};
-    runner.wait();
-
-    if (distance_out.is_open()) {
-        std::clog << "Writing distances..." << std::endl;
-        for (std::size_t i = 0; i < shared_data.shortest_distances.size(); ++i) {
-            distance_out << i << ' ' << shared_data.shortest_distances[i].value << '\n';
+    if (settings.update_batches > 0) {
+        if (settings.target != no_target) {
+            std::clog << "Error: Weight updates require all distances" << std::endl;
+            return false;
+        }
+        if (graph.num_edges() == 0 ||
+            std::any_of(graph.edges.begin(), graph.edges.end(), [](auto const& e) { return e.weight <= 0; })) {
+            std::clog << "Error: Weight updates require edges with positive weights" << std::endl;
+            return false;
         }
-        distance_out.close();
     }
-    std::clog << "Finished\n" << std::endl;
-    auto accum_stats =
-        std::accumulate(all_stats.begin() + 1, all_stats.end(), all_stats.front(), [](auto accum, auto const& e) {
-            accum.work_time.first = std::min(accum.work_time.first, e.work_time.first);
-            accum.work_time.second = std::max(accum.work_time.second, e.work_time.second);
-            accum.pushed_nodes += e.pushed_nodes;
-            accum.processed_nodes += e.processed_nodes;
-            accum.ignored_nodes += e.ignored_nodes;
-            return accum;
-        });
-    std::clog << "Time (s): " << std::setprecision(3)
-              << std::chrono::duration<double>(accum_stats.work_time.second - accum_stats.work_time.first).count()
-              << '\n';
-    std::clog << "Pushed nodes: " << accum_stats.pushed_nodes << '\n';
-    std::clog << "Processed nodes: " << accum_stats.processed_nodes << '\n';
-    std::clog << "Ignored nodes: " << accum_stats.ignored_nodes << '\n';
-    if (accum_stats.processed_nodes + accum_stats.ignored_nodes != accum_stats.pushed_nodes) {
-        std::clog << "Error: " << accum_stats.pushed_nodes - (accum_stats.processed_nodes + accum_stats.ignored_nodes)
-                  << " node(s) were not popped" << std::endl;
-        return false;
+    if (settings.vectorized_relaxation) {
+        graph.split_edges();
     }
-    if (!verify_distances(shared_data)) {
-        std::clog << "Error: Invalid distances" << std::endl;
+    file_data_type shared_data{graph};
+    if (!run_search(settings, args, shared_data, distance_out)) {
         return false;
     }
-    write_stats(accum_stats, std::cout);
+    if (settings.update_batches > 0) {
+        return run_updates(settings, args, graph, shared_data);
+    }
     return true;
 }
 
@@ -231,13 +942,31 @@ int main(int argc, char* argv[]) {
       ("j,threads", "The number of threads", cxxopts::value<int>(settings.num_threads), "NUMBER")
       ("file", "The input graph", cxxopts::value<std::filesystem::path>(settings.graph_file), "PATH")
       ("o,distance-file", "Path to write the distances to", cxxopts::value<std::filesystem::path>(settings.distance_file), "PATH")
+      ("b,binary-distances", "Write the distances in binary format", cxxopts::value<bool>(settings.binary_distances))
+      ("local-window", "Push keys within this distance of the current key to a thread-local queue", cxxopts::value<long long>(settings.local_window), "NUMBER")
+      ("local-capacity", "Capacity of the thread-local queue", cxxopts::value<std::size_t>(settings.local_capacity), "NUMBER")
+      ("coarsen-shift", "Drop this many low bits of the distance keys", cxxopts::value<unsigned int>(settings.coarsen_shift), "NUMBER")
+      ("coarsen-delta", "Divide the distance keys by this value (excludes --coarsen-shift)", cxxopts::value<unsigned long>(settings.coarsen_delta), "NUMBER")
+      ("hub-degree", "Split the edges of nodes with a higher degree into chunks relaxed by different threads (0 disables)", cxxopts::value<std::size_t>(settings.hub_degree), "NUMBER")
+      ("hub-chunk", "The number of edges per chunk of a split node", cxxopts::value<std::size_t>(settings.hub_chunk_size), "NUMBER")
+      ("t,target", "Only compute the distance to this node", cxxopts::value<std::size_t>(settings.target), "NODE")
+      ("bidirectional", "Search from both the source and the target", cxxopts::value<bool>(settings.bidirectional))
+      ("grid", "Use an implicit grid graph with these extents instead of a file", cxxopts::value<std::string>(settings.grid), "XxY[xZ]")
+      ("torus", "Wrap the implicit grid around", cxxopts::value<bool>(settings.torus))
+      ("max-weight", "Maximum edge weight of the implicit grid", cxxopts::value<long long>(settings.max_weight), "NUMBER")
+      ("s,seed", "Seed for the weight updates and the implicit grid weights", cxxopts::value<int>(settings.seed), "NUMBER")
+      ("update-batches", "After solving, apply this many batches of random weight updates and repair the distances", cxxopts::value<int>(settings.update_batches), "NUMBER")
+      ("batch-size", "The number of weight updates per batch", cxxopts::value<std::size_t>(settings.batch_size), "NUMBER")
+      ("simd", "Relax edges with vector instructions", cxxopts::value<bool>(settings.vectorized_relaxation))
+      ("queued-keys", "Skip pushes if a node is already queued with a better key", cxxopts::value<bool>(settings.track_queued_keys))
       ("h,help", "Print this help");
     // clang-format on
-    pq_type::add_options(cmd, settings.pq_settings);
+    add_options(cmd);
     cmd.parse_positional({"file"});
 
+    auto args = cxxopts::ParseResult{};
     try {
-        auto args = cmd.parse(argc, argv);
+        args = cmd.parse(argc, argv);
         if (args.count("help") > 0) {
             std::cerr << cmd.help() << std::endl;
             return EXIT_SUCCESS;
@@ -248,9 +977,17 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
+    try {
+        // Only validates the options
+        (void)settings.coarsening();
+    } catch (std::invalid_argument const& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
     write_settings(settings, std::clog);
 
-    bool success = run_benchmark(settings);
+    bool success = run_benchmark(settings, args);
 
     return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -1,8 +1,13 @@
 #include "build_info.hpp"
+#include "bucket_queue.hpp"
+#include "distance_file.hpp"
 #include "graph.hpp"
+#include "pairing_heap.hpp"
+#include "radix_heap.hpp"
 
 #include "cxxopts.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
@@ -30,8 +35,20 @@ struct Node {
     }
 };
 
+struct NodeDistance {
+    static long long get(Node const& node) noexcept {
+        return node.distance;
+    }
+};
+
 #ifdef USE_FIFO
 using PriorityQueue = std::queue<Node>;
+#elif defined USE_RADIX_HEAP
+using PriorityQueue = RadixHeap<Node, NodeDistance>;
+#elif defined USE_DIAL
+using PriorityQueue = BucketQueue<Node, NodeDistance>;
+#elif defined USE_PAIRING_HEAP
+using PriorityQueue = IndexedPairingHeap<long long>;
 #else
 #ifdef REVERSE_PRIORITY
 using PriorityQueue = std::priority_queue<Node, std::vector<Node>, std::less<>>;
@@ -49,6 +66,28 @@ struct Data {
     }
 };
 
+#ifdef USE_PAIRING_HEAP
+// With decrease-key every node is popped exactly once, so no node is ignored
+void dijkstra(PriorityQueue& pq, Data& data, Graph const& graph) {
+    while (!pq.empty()) {
+        auto [distance, id] = pq.top();
+        pq.pop();
+        ++data.processed_nodes;
+        for (std::size_t i = graph.nodes[id]; i < graph.nodes[id + 1]; ++i) {
+            auto target = graph.edges[i].target;
+            auto d = distance + graph.edges[i].weight;
+            if (d < data.shortest_distances[target]) {
+                if (pq.contains(target)) {
+                    pq.decrease_key(target, d);
+                } else {
+                    pq.push(target, d);
+                }
+                data.shortest_distances[target] = d;
+            }
+        }
+    }
+}
+#else
 void dijkstra(PriorityQueue& pq, Data& data, Graph const& graph) noexcept {
     while (!pq.empty()) {
 #ifdef USE_FIFO
@@ -72,6 +111,7 @@ void dijkstra(PriorityQueue& pq, Data& data, Graph const& graph) noexcept {
         }
     }
 }
+#endif
 
 int main(int argc, char* argv[]) {
     write_build_info(std::clog);
@@ -84,12 +124,14 @@ int main(int argc, char* argv[]) {
 
     std::filesystem::path graph_file;
     std::filesystem::path distance_file;
+    bool binary_distances = false;
 
     cxxopts::Options options(argv[0]);
     // clang-format off
     options.add_options()
       ("file", "The input graph", cxxopts::value<std::filesystem::path>(graph_file)->default_value("graph.gr"), "PATH")
       ("o,distance-file", "Path to write the distances to", cxxopts::value<std::filesystem::path>(distance_file), "PATH")
+      ("b,binary-distances", "Write the distances in binary format", cxxopts::value<bool>(binary_distances))
       ("h,help", "Print this help");
     // clang-format on
     options.parse_positional({"file"});
@@ -109,7 +151,7 @@ int main(int argc, char* argv[]) {
         }
     }
     std::ofstream distance_out;
-    if (!distance_file.empty()) {
+    if (!distance_file.empty() && !binary_distances) {
         distance_out = std::ofstream(distance_file);
         if (!distance_out) {
             std::cerr << "Error: Could not open file " << distance_file << " for writing" << std::endl;
@@ -124,11 +166,28 @@ int main(int argc, char* argv[]) {
         std::cerr << "\nError reading graph: " << e.what() << std::endl;
         return 1;
     }
+    if (graph.num_nodes() == 0) {
+        std::cerr << "Error: The graph has no nodes" << std::endl;
+        return EXIT_FAILURE;
+    }
 
+#if defined USE_DIAL
+    auto max_weight = std::max_element(graph.edges.begin(), graph.edges.end(), [](auto const& lhs, auto const& rhs) {
+        return lhs.weight < rhs.weight;
+    });
+    PriorityQueue pq(max_weight == graph.edges.end() ? 0 : static_cast<std::size_t>(max_weight->weight));
+#elif defined USE_PAIRING_HEAP
+    PriorityQueue pq(graph.num_nodes());
+#else
     PriorityQueue pq;
+#endif
     Data data(graph.num_nodes());
     data.shortest_distances[0] = 0;
+#ifdef USE_PAIRING_HEAP
+    pq.push(0, 0);
+#else
     pq.push({0, 0});
+#endif
 
     std::clog << "Computing shortest paths..." << std::endl;
     auto t_start = std::chrono::steady_clock::now();
@@ -142,6 +201,15 @@ int main(int argc, char* argv[]) {
             distance_out << i << ' ' << data.shortest_distances[i] << '\n';
         }
         distance_out.close();
+    } else if (!distance_file.empty()) {
+        std::clog << "Writing distances..." << std::endl;
+        try {
+            distance_file::write_binary(distance_file, graph.num_nodes(),
+                                        [&](std::size_t i) { return data.shortest_distances[i]; });
+        } catch (std::runtime_error const& e) {
+            std::cerr << "Error writing " << distance_file << ": " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
     }
     std::clog << "Finished\n" << std::endl;
 
@@ -0,0 +1,79 @@
+#include "util/node_pool.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+using pool_type = NodePool<std::uint64_t>;
+
+TEST_CASE("node_pool reuses slots in the freeing arena", "[node_pool]") {
+    pool_type pool{2, false};
+    std::vector<pool_type::handle_type> handles;
+    for (std::uint64_t i = 0; i < pool_type::chunk_size + 10; ++i) {
+        handles.push_back(pool.allocate(0, i));
+    }
+    for (std::uint64_t i = 0; i < handles.size(); ++i) {
+        REQUIRE((handles[i] >> pool_type::arena_shift) == 0);
+        REQUIRE(pool[handles[i]] == i);
+    }
+    REQUIRE(pool.allocated_slots() == pool_type::chunk_size + 10);
+    // Without returning home, arena 1 keeps the slot of arena 0
+    pool.free(1, handles[5]);
+    auto reused = pool.allocate(1, 42);
+    REQUIRE(reused == handles[5]);
+    REQUIRE(pool[reused] == 42);
+    REQUIRE(pool.allocated_slots() == pool_type::chunk_size + 10);
+    auto fresh = pool.allocate(1, 43);
+    REQUIRE((fresh >> pool_type::arena_shift) == 1);
+}
+
+TEST_CASE("node_pool returns slots home while the owner allocates", "[node_pool]") {
+    constexpr int num_freeing_threads = 3;
+    constexpr std::size_t per_thread = 20'000;
+    constexpr std::size_t num_nodes = num_freeing_threads * per_thread;
+    pool_type pool{num_freeing_threads + 1, true};
+    REQUIRE(pool.return_home());
+    std::vector<pool_type::handle_type> handles;
+    for (std::uint64_t i = 0; i < num_nodes; ++i) {
+        handles.push_back(pool.allocate(0, i));
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_freeing_threads; ++t) {
+        threads.emplace_back([&, t]() noexcept {
+            auto begin = static_cast<std::size_t>(t) * per_thread;
+            for (auto i = begin; i < begin + per_thread; ++i) {
+                pool.free(t + 1, handles[i]);
+            }
+        });
+    }
+    // The owner collects returned slots concurrently with the frees
+    std::vector<pool_type::handle_type> owner_handles;
+    for (std::uint64_t i = 0; i < num_nodes; ++i) {
+        owner_handles.push_back(pool.allocate(0, num_nodes + i));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::size_t reused = 0;
+    for (auto handle : owner_handles) {
+        REQUIRE((handle >> pool_type::arena_shift) == 0);
+        if ((handle & ((pool_type::handle_type{1} << pool_type::arena_shift) - 1)) < num_nodes) {
+            ++reused;
+        }
+    }
+    // Every returned slot is eventually handed out again, without growing the arena
+    auto slots = pool.allocated_slots();
+    REQUIRE(slots == 2 * num_nodes - reused);
+    for (std::uint64_t i = 0; i < num_nodes - reused; ++i) {
+        owner_handles.push_back(pool.allocate(0, 2 * num_nodes + i));
+    }
+    REQUIRE(pool.allocated_slots() == slots);
+    std::set<pool_type::handle_type> distinct(owner_handles.begin(), owner_handles.end());
+    REQUIRE(distinct.size() == owner_handles.size());
+    for (std::uint64_t i = 0; i < owner_handles.size(); ++i) {
+        REQUIRE(pool[owner_handles[i]] == num_nodes + i);
+    }
+}
@@ -0,0 +1,115 @@
+#include "util/bucket_queue.hpp"
+#include "util/pairing_heap.hpp"
+#include "util/radix_heap.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+using entry_type = std::pair<std::uint64_t, std::size_t>;
+
+struct first_of_entry {
+    static std::uint64_t const& get(entry_type const& e) {
+        return e.first;
+    }
+};
+
+// Dijkstra-like workload: every pushed key lies in [last popped key, last popped key + max_step]. Compares the popped
+// keys with std::priority_queue.
+template <typename Queue>
+void check_monotone(Queue& queue, std::uint64_t max_step, unsigned int seed) {
+    std::priority_queue<std::uint64_t, std::vector<std::uint64_t>, std::greater<>> reference;
+    std::mt19937_64 rng{seed};
+    std::uniform_int_distribution<std::uint64_t> step_dist{0, max_step};
+    std::uint64_t last = 0;
+    std::size_t next_id = 0;
+    queue.push({0, next_id++});
+    reference.push(0);
+    while (!reference.empty()) {
+        REQUIRE(queue.size() == reference.size());
+        REQUIRE(queue.top().first == reference.top());
+        last = reference.top();
+        queue.pop();
+        reference.pop();
+        auto num_pushes = next_id < 100'000 ? rng() % 4 : 0;
+        for (std::uint64_t i = 0; i < num_pushes; ++i) {
+            auto k = last + step_dist(rng);
+            queue.push({k, next_id++});
+            reference.push(k);
+        }
+    }
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("radix_heap pops in key order", "[sequential_heaps]") {
+    RadixHeap<entry_type, first_of_entry> small_steps;
+    check_monotone(small_steps, 100, 1);
+    // Keys that differ in high bits are moved down over many buckets
+    RadixHeap<entry_type, first_of_entry> large_steps;
+    check_monotone(large_steps, std::uint64_t{1} << 40, 2);
+}
+
+TEST_CASE("radix_heap handles equal keys", "[sequential_heaps]") {
+    RadixHeap<entry_type, first_of_entry> heap;
+    for (std::size_t i = 0; i < 10; ++i) {
+        heap.push({5, i});
+    }
+    heap.push({3, 10});
+    REQUIRE(heap.top().first == 3);
+    heap.pop();
+    for (std::size_t i = 0; i < 10; ++i) {
+        REQUIRE(heap.top().first == 5);
+        heap.pop();
+    }
+    REQUIRE(heap.empty());
+}
+
+TEST_CASE("bucket_queue pops in key order", "[sequential_heaps]") {
+    BucketQueue<entry_type, first_of_entry> queue{100};
+    check_monotone(queue, 100, 3);
+    // Every key in its own bucket, which wraps around many times
+    BucketQueue<entry_type, first_of_entry> single_step{1};
+    check_monotone(single_step, 1, 4);
+}
+
+TEST_CASE("pairing_heap supports decrease_key", "[sequential_heaps]") {
+    constexpr std::size_t n = 10'000;
+    IndexedPairingHeap<long long> heap{n};
+    std::set<std::pair<long long, std::size_t>> reference;
+    std::vector<long long> keys(n);
+    std::mt19937_64 rng{5};
+    std::uniform_int_distribution<long long> key_dist{0, 1'000'000};
+    for (std::size_t i = 0; i < n; ++i) {
+        keys[i] = key_dist(rng);
+        heap.push(i, keys[i]);
+        reference.insert({keys[i], i});
+    }
+    while (!reference.empty()) {
+        REQUIRE(heap.size() == reference.size());
+        // Decrease a few random keys, possibly below the current minimum
+        for (int j = 0; j < 3; ++j) {
+            auto index = static_cast<std::size_t>(rng() % n);
+            if (!heap.contains(index)) {
+                continue;
+            }
+            auto key = keys[index] - key_dist(rng) / 2;
+            reference.erase({keys[index], index});
+            keys[index] = key;
+            heap.decrease_key(index, key);
+            reference.insert({key, index});
+        }
+        auto [key, index] = heap.top();
+        REQUIRE(key == reference.begin()->first);
+        REQUIRE(keys[index] == key);
+        heap.pop();
+        REQUIRE(!heap.contains(index));
+        reference.erase({key, index});
+    }
+    REQUIRE(heap.empty());
+}
@@ -0,0 +1,133 @@
+#include "util/work_stealing_deque.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST_CASE("work_stealing_deque pop is LIFO", "[work_stealing_deque]") {
+    WorkStealingDeque<int> deque{4};
+    REQUIRE(!deque.pop());
+    for (int i = 0; i < 100; ++i) {
+        deque.push(i);
+    }
+    for (int i = 99; i >= 0; --i) {
+        auto element = deque.pop();
+        REQUIRE(element);
+        REQUIRE(*element == i);
+    }
+    REQUIRE(!deque.pop());
+    REQUIRE(deque.max_size() == 100);
+}
+
+TEST_CASE("work_stealing_deque steal is FIFO", "[work_stealing_deque]") {
+    WorkStealingDeque<std::pair<unsigned long, unsigned long>> deque{4};
+    REQUIRE(!deque.steal());
+    for (unsigned long i = 0; i < 100; ++i) {
+        deque.push({i, 2 * i});
+    }
+    for (unsigned long i = 0; i < 50; ++i) {
+        auto element = deque.steal();
+        REQUIRE(element);
+        REQUIRE(element->first == i);
+        REQUIRE(element->second == 2 * i);
+    }
+    // Both ends on the same deque
+    auto last = deque.pop();
+    REQUIRE(last);
+    REQUIRE(last->first == 99);
+    auto first = deque.steal();
+    REQUIRE(first);
+    REQUIRE(first->first == 50);
+}
+
+TEST_CASE("work_stealing_deque grows while thieves steal", "[work_stealing_deque]") {
+    constexpr int num_thieves = 3;
+    constexpr int num_elements = 200'000;
+    WorkStealingDeque<int> deque{2};
+    std::vector<std::atomic_int> taken(num_elements);
+    // Thieves start once the buffer has grown a few times, so that it is not drained while still small
+    std::atomic_bool started{false};
+    std::atomic_bool done{false};
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < num_thieves; ++t) {
+        thieves.emplace_back([&]() noexcept {
+            while (!started.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            while (!done.load(std::memory_order_acquire)) {
+                if (auto element = deque.steal(); element) {
+                    taken[static_cast<std::size_t>(*element)].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < num_elements; ++i) {
+        deque.push(i);
+        if (i == 64) {
+            started.store(true, std::memory_order_release);
+        }
+        // Pop now and then so that the owner also races on the bottom end while the buffer grows
+        if (i % 7 == 0) {
+            if (auto element = deque.pop(); element) {
+                taken[static_cast<std::size_t>(*element)].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    while (auto element = deque.pop()) {
+        taken[static_cast<std::size_t>(*element)].fetch_add(1, std::memory_order_relaxed);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+    for (auto const& count : taken) {
+        REQUIRE(count.load() == 1);
+    }
+    REQUIRE(deque.max_size() > 64);
+}
+
+TEST_CASE("work_stealing_deque last element goes to exactly one thread", "[work_stealing_deque]") {
+    constexpr int num_thieves = 3;
+    constexpr int num_rounds = 100'000;
+    WorkStealingDeque<int> deque;
+    std::vector<std::atomic_int> taken(num_rounds);
+    // Thieves steal in round `round` once they see it, the owner waits for all of them before the next round
+    std::atomic_int round{-1};
+    std::atomic_int arrived{0};
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < num_thieves; ++t) {
+        thieves.emplace_back([&]() noexcept {
+            for (int r = 0; r < num_rounds; ++r) {
+                while (round.load(std::memory_order_acquire) < r) {
+                    std::this_thread::yield();
+                }
+                if (auto element = deque.steal(); element) {
+                    taken[static_cast<std::size_t>(*element)].fetch_add(1, std::memory_order_relaxed);
+                }
+                arrived.fetch_add(1, std::memory_order_acq_rel);
+            }
+        });
+    }
+    for (int r = 0; r < num_rounds; ++r) {
+        deque.push(r);
+        round.store(r, std::memory_order_release);
+        if (auto element = deque.pop(); element) {
+            taken[static_cast<std::size_t>(*element)].fetch_add(1, std::memory_order_relaxed);
+        }
+        while (arrived.load(std::memory_order_acquire) < (r + 1) * num_thieves) {
+            std::this_thread::yield();
+        }
+        // The element is gone either way, so both ends see an empty deque
+        REQUIRE(!deque.pop());
+        REQUIRE(!deque.steal());
+    }
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+    for (auto const& count : taken) {
+        REQUIRE(count.load() == 1);
+    }
+}
@@ -0,0 +1,87 @@
+#include "distance_file.hpp"
+#include "task.hpp"
+
+#include "cxxopts.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+struct ThreadResult {
+    std::size_t mismatches = 0;
+    std::size_t first_mismatch = std::numeric_limits<std::size_t>::max();
+};
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options("Compare distances", "Compare binary distance files");
+    std::filesystem::path result_file;
+    std::filesystem::path reference_file;
+    int num_threads = 4;
+    // clang-format off
+    options.add_options()
+      ("j,threads", "The number of threads", cxxopts::value<int>(num_threads), "NUMBER")
+      ("result", "The distances to check", cxxopts::value<std::filesystem::path>(result_file), "PATH")
+      ("reference", "The reference distances", cxxopts::value<std::filesystem::path>(reference_file), "PATH")
+      ("h,help", "Print this help");
+    // clang-format on
+    options.parse_positional({"result", "reference"});
+
+    try {
+        auto result = options.parse(argc, argv);
+        if (result.count("help") > 0) {
+            std::cerr << options.help() << std::endl;
+            return 0;
+        }
+    } catch (cxxopts::OptionParseException const& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (result_file.empty() || reference_file.empty()) {
+        std::cerr << options.help() << std::endl;
+        return 1;
+    }
+
+    try {
+        distance_file::MappedDistances result{result_file};
+        distance_file::MappedDistances reference{reference_file};
+        if (result.num_nodes() != reference.num_nodes()) {
+            std::cerr << "Number of nodes differs: " << result.num_nodes() << " vs. " << reference.num_nodes()
+                      << std::endl;
+            return 1;
+        }
+        std::vector<ThreadResult> thread_results(static_cast<std::size_t>(num_threads));
+        task::Runner runner{num_threads, [&](auto tc) noexcept {
+                                auto id = static_cast<std::size_t>(tc.id());
+                                auto p = static_cast<std::size_t>(tc.num_threads());
+                                ThreadResult r;
+                                for (std::size_t i = result.num_nodes() * id / p;
+                                     i < result.num_nodes() * (id + 1) / p; ++i) {
+                                    if (result[i] != reference[i]) {
+                                        r.first_mismatch = std::min(r.first_mismatch, i);
+                                        ++r.mismatches;
+                                    }
+                                }
+                                thread_results[id] = r;
+                            }};
+        runner.wait();
+        ThreadResult total;
+        for (auto const& r : thread_results) {
+            total.mismatches += r.mismatches;
+            total.first_mismatch = std::min(total.first_mismatch, r.first_mismatch);
+        }
+        std::cout << "Nodes: " << result.num_nodes() << '\n' << "Mismatches: " << total.mismatches << '\n';
+        if (total.mismatches > 0) {
+            std::cout << "First mismatch: node " << total.first_mismatch << " (" << result[total.first_mismatch]
+                      << " vs. " << reference[total.first_mismatch] << ")\n";
+            return 1;
+        }
+    } catch (std::runtime_error const& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
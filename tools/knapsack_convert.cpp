@@ -0,0 +1,63 @@
+#include "knapsack_instance.hpp"
+
+#include "cxxopts.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+template <typename InstanceType>
+void convert(std::filesystem::path const& input_file, std::filesystem::path const& output_file,
+             unsigned int num_threads) {
+    auto start = std::chrono::steady_clock::now();
+    auto instance = InstanceType(input_file, num_threads);
+    auto end = std::chrono::steady_clock::now();
+    std::clog << "Items: " << instance.size() << '\n'
+              << "Load time (s): " << std::chrono::duration<double>(end - start).count() << '\n';
+    instance.write_binary(output_file);
+}
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options("Knapsack converter", "Convert knapsack instances to the sorted binary format");
+    std::filesystem::path input_file;
+    std::filesystem::path output_file;
+    unsigned int num_threads = 4;
+    bool use_doubles = false;
+    // clang-format off
+    options.add_options()
+      ("j,threads", "The number of threads for sorting", cxxopts::value<unsigned int>(num_threads), "NUMBER")
+      ("input", "The instance to convert", cxxopts::value<std::filesystem::path>(input_file), "PATH")
+      ("output", "The binary instance to write", cxxopts::value<std::filesystem::path>(output_file), "PATH")
+      ("d,doubles", "Use doubles", cxxopts::value<bool>(use_doubles))
+      ("h,help", "Print this help");
+    // clang-format on
+    options.parse_positional({"input", "output"});
+
+    try {
+        auto result = options.parse(argc, argv);
+        if (result.count("help") > 0) {
+            std::cerr << options.help() << std::endl;
+            return 0;
+        }
+    } catch (cxxopts::OptionParseException const& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (input_file.empty() || output_file.empty()) {
+        std::cerr << options.help() << std::endl;
+        return 1;
+    }
+
+    try {
+        if (use_doubles) {
+            convert<KnapsackInstance<double>>(input_file, output_file, num_threads);
+        } else {
+            convert<KnapsackInstance<long long>>(input_file, output_file, num_threads);
+        }
+    } catch (std::runtime_error const& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,63 +1,345 @@
+#include "knapsack_instance.hpp"
+
 #include "cxxopts.hpp"
 
-#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
-#include <random>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-template <typename WeightType = long long, typename ValueType = WeightType>
-struct Item {
-    WeightType weight;
-    ValueType value;
+// The classes of Pisinger, "Where are the hard knapsack problems?" (2005), and the original class whose values add a
+// uniform offset to the weight
+enum class InstanceClass {
+    offset,
+    uncorrelated,
+    weakly_correlated,
+    strongly_correlated,
+    inverse_strongly_correlated,
+    almost_strongly_correlated,
+    subset_sum,
+    similar_weights,
+    spanner_uncorrelated,
+    spanner_weakly_correlated,
+    spanner_strongly_correlated,
+    profit_ceiling,
+    circle,
 };
 
-template <typename WeightType = long long, typename ValueType = WeightType>
-void generate_knapsack_instance(long long n, WeightType a, WeightType b, ValueType l, ValueType u, double f,
-                                unsigned long s) {
-    std::vector<Item<WeightType, ValueType>> elements(static_cast<std::size_t>(n));
-    std::default_random_engine rng(s);
-    std::generate(elements.begin(), elements.end(), [&rng, a, b, l, u]() {
-        if constexpr (std::is_floating_point_v<WeightType>) {
-            std::uniform_real_distribution<WeightType> random_weight(a, b);
-            std::uniform_real_distribution<ValueType> random_add(l, u);
-            auto weight = random_weight(rng);
-            return Item<WeightType, ValueType>{weight, static_cast<ValueType>(weight) + random_add(rng)};
+constexpr std::array<std::pair<char const*, InstanceClass>, 13> instance_classes{{
+    {"offset", InstanceClass::offset},
+    {"uncorrelated", InstanceClass::uncorrelated},
+    {"weakly", InstanceClass::weakly_correlated},
+    {"strongly", InstanceClass::strongly_correlated},
+    {"inverse-strongly", InstanceClass::inverse_strongly_correlated},
+    {"almost-strongly", InstanceClass::almost_strongly_correlated},
+    {"subset-sum", InstanceClass::subset_sum},
+    {"similar-weights", InstanceClass::similar_weights},
+    {"spanner-uncorrelated", InstanceClass::spanner_uncorrelated},
+    {"spanner-weakly", InstanceClass::spanner_weakly_correlated},
+    {"spanner-strongly", InstanceClass::spanner_strongly_correlated},
+    {"profit-ceiling", InstanceClass::profit_ceiling},
+    {"circle", InstanceClass::circle},
+}};
+
+struct Parameters {
+    InstanceClass instance_class = InstanceClass::offset;
+    long long n = 1000;
+    // Weight range and value offsets of the offset class
+    double a = 1000;
+    double b = 100000;
+    double l = 10000;
+    double u = 12500;
+    // Data range R of the other classes, weights are drawn from [1, R]
+    double range = 1000;
+    double f = 2;
+    unsigned long seed = 1;
+    // Number of spanner items and the largest multiplier
+    long long spanner_size = 2;
+    long long spanner_multiplier = 10;
+    double profit_ceiling = 3;
+    double circle = 2.0 / 3.0;
+};
+
+// Counter-based random numbers: draw `stream` of item `counter` only depends on the seed and these two numbers, so
+// blocks of items can be generated in parallel and the instance does not depend on the number of threads
+class CounterRng {
+    std::uint64_t key_;
+
+    // Finalizer of SplitMix64
+    static constexpr std::uint64_t mix(std::uint64_t x) noexcept {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+   public:
+    explicit CounterRng(std::uint64_t seed) noexcept : key_{mix(seed + 0x9e3779b97f4a7c15ULL)} {
+    }
+
+    [[nodiscard]] std::uint64_t operator()(std::uint64_t counter, unsigned int stream) const noexcept {
+        return mix(mix(counter * 4 + stream) ^ key_);
+    }
+
+    // Uniform in [low, high], integers by multiplying into the range, whose bias is negligible for the ranges used
+    template <typename T>
+    [[nodiscard]] T uniform(std::uint64_t counter, unsigned int stream, T low, T high) const noexcept {
+        auto bits = (*this)(counter, stream);
+        if constexpr (std::is_integral_v<T>) {
+            __extension__ typedef unsigned __int128 wide_type;
+            auto size = static_cast<std::uint64_t>(high - low) + 1;
+            return low + static_cast<T>((static_cast<wide_type>(bits) * size) >> 64);
+        } else {
+            return low + static_cast<T>(static_cast<double>(bits >> 11) * 0x1.0p-53) * (high - low);
+        }
+    }
+};
+
+template <typename WeightType, typename ValueType>
+class Generator {
+   public:
+    using instance_type = KnapsackInstance<WeightType, ValueType>;
+    using item_type = typename instance_type::Item;
+
+   private:
+    Parameters params_;
+    CounterRng rng_;
+    WeightType range_;
+    std::vector<item_type> spanners_;
+
+    // Rounds down for integral types
+    template <typename T>
+    static T convert(double x) noexcept {
+        if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(std::floor(x));
         } else {
-            std::uniform_int_distribution<WeightType> random_weight(a, b);
-            std::uniform_int_distribution<ValueType> random_add(l, u);
-            auto weight = random_weight(rng);
-            return Item<WeightType, ValueType>{weight, static_cast<ValueType>(weight) + random_add(rng)};
+            return static_cast<T>(x);
+        }
+    }
+
+    template <typename T>
+    T uniform(std::uint64_t counter, unsigned int stream, T low, T high) const noexcept {
+        return rng_.uniform(counter, stream, low, high);
+    }
+
+    // The weight and value of the correlation classes, drawn with `counter`
+    item_type correlated(InstanceClass base, std::uint64_t counter) const noexcept {
+        auto w = uniform(counter, 0, WeightType{1}, range_);
+        auto r = static_cast<ValueType>(range_) / 10;
+        switch (base) {
+            case InstanceClass::weakly_correlated:
+                return {w, uniform(counter, 1, std::max(ValueType{1}, static_cast<ValueType>(w) - r),
+                                   static_cast<ValueType>(w) + r)};
+            case InstanceClass::strongly_correlated:
+                return {w, static_cast<ValueType>(w) + r};
+            default:
+                return {w, uniform(counter, 1, ValueType{1}, static_cast<ValueType>(range_))};
+        }
+    }
+
+   public:
+    explicit Generator(Parameters const& params)
+        : params_{params}, rng_{params.seed}, range_{convert<WeightType>(params.range)} {
+        if (params.instance_class != InstanceClass::offset && range_ < WeightType{10}) {
+            throw std::runtime_error{"The range must be at least 10"};
+        }
+        auto base = InstanceClass::uncorrelated;
+        if (params.instance_class == InstanceClass::spanner_weakly_correlated) {
+            base = InstanceClass::weakly_correlated;
+        } else if (params.instance_class == InstanceClass::spanner_strongly_correlated) {
+            base = InstanceClass::strongly_correlated;
+        } else if (params.instance_class != InstanceClass::spanner_uncorrelated) {
+            return;
+        }
+        if (params.spanner_size < 1 || params.spanner_multiplier < 1) {
+            throw std::runtime_error{"The spanner size and multiplier must be positive"};
+        }
+        // The spanner items use the counters after the regular items
+        auto m = static_cast<double>(params.spanner_multiplier);
+        for (long long k = 0; k < params.spanner_size; ++k) {
+            auto item = correlated(base, static_cast<std::uint64_t>(params.n + k));
+            spanners_.push_back({convert<WeightType>(std::ceil(2.0 * static_cast<double>(item.weight) / m)),
+                                 convert<ValueType>(std::ceil(2.0 * static_cast<double>(item.value) / m))});
+        }
+    }
+
+    [[nodiscard]] item_type item(std::uint64_t i) const noexcept {
+        auto r = static_cast<double>(range_);
+        switch (params_.instance_class) {
+            case InstanceClass::offset: {
+                auto w = uniform(i, 0, convert<WeightType>(params_.a), convert<WeightType>(params_.b));
+                return {w, static_cast<ValueType>(w) +
+                            uniform(i, 1, convert<ValueType>(params_.l), convert<ValueType>(params_.u))};
+            }
+            case InstanceClass::uncorrelated:
+            case InstanceClass::weakly_correlated:
+            case InstanceClass::strongly_correlated:
+                return correlated(params_.instance_class, i);
+            case InstanceClass::inverse_strongly_correlated: {
+                auto p = uniform(i, 1, ValueType{1}, static_cast<ValueType>(range_));
+                return {static_cast<WeightType>(p) + range_ / 10, p};
+            }
+            case InstanceClass::almost_strongly_correlated: {
+                auto w = uniform(i, 0, WeightType{1}, range_);
+                auto center = static_cast<ValueType>(w) + static_cast<ValueType>(range_) / 10;
+                auto spread = std::max(static_cast<ValueType>(range_) / 500, ValueType{});
+                return {w, uniform(i, 1, center - spread, center + spread)};
+            }
+            case InstanceClass::subset_sum: {
+                auto w = uniform(i, 0, WeightType{1}, range_);
+                return {w, static_cast<ValueType>(w)};
+            }
+            case InstanceClass::similar_weights:
+                return {uniform(i, 0, WeightType{100000}, WeightType{100100}),
+                        uniform(i, 1, ValueType{1}, ValueType{1000})};
+            case InstanceClass::spanner_uncorrelated:
+            case InstanceClass::spanner_weakly_correlated:
+            case InstanceClass::spanner_strongly_correlated: {
+                auto const& spanner = spanners_[uniform(i, 2, std::size_t{0}, spanners_.size() - 1)];
+                auto multiplier = uniform(i, 3, 1LL, params_.spanner_multiplier);
+                return {static_cast<WeightType>(multiplier) * spanner.weight,
+                        static_cast<ValueType>(multiplier) * spanner.value};
+            }
+            case InstanceClass::profit_ceiling: {
+                auto w = uniform(i, 0, WeightType{1}, range_);
+                auto d = params_.profit_ceiling;
+                return {w, convert<ValueType>(d * std::ceil(static_cast<double>(w) / d))};
+            }
+            case InstanceClass::circle: {
+                auto w = uniform(i, 0, WeightType{1}, range_);
+                auto x = static_cast<double>(w) - 2.0 * r;
+                return {w, convert<ValueType>(params_.circle * std::sqrt(4.0 * r * r - x * x))};
+            }
+        }
+        return {};
+    }
+
+    // The offset class keeps its original capacity, the others use a fraction of the total weight
+    [[nodiscard]] WeightType capacity(WeightType total_weight) const noexcept {
+        if (params_.instance_class == InstanceClass::offset) {
+            return convert<WeightType>(static_cast<double>(params_.n) * (params_.b - params_.a) / params_.f);
+        }
+        return convert<WeightType>(static_cast<double>(total_weight) / params_.f);
+    }
+};
+
+// Calls `f(thread, begin, end)` for equal blocks of [0, n) in parallel
+template <typename F>
+void parallel_blocks(std::size_t n, unsigned int num_threads, F f) {
+    num_threads = std::max(1U, std::min(num_threads, static_cast<unsigned int>(n / 4096 + 1)));
+    auto block_size = (n + num_threads - 1) / num_threads;
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < num_threads; ++t) {
+        workers.emplace_back(f, t, std::min(t * block_size, n), std::min((t + 1) * block_size, n));
+    }
+    f(0U, std::size_t{0}, std::min(block_size, n));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+template <typename T>
+void append_number(std::string& out, T number) {
+    std::array<char, 64> buffer{};
+    auto res = std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+    out.append(buffer.data(), res.ptr);
+}
+
+// The text format read by KnapsackInstance: number of items, capacity, then value and weight of each item. Blocks
+// of items are formatted in parallel and written in order.
+template <typename Item, typename WeightType>
+void write_text(std::vector<Item> const& items, WeightType capacity, unsigned int num_threads, std::ostream& out) {
+    std::string header;
+    append_number(header, items.size());
+    header += '\n';
+    append_number(header, capacity);
+    header += "\n\n";
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    std::vector<std::string> blocks(num_threads);
+    parallel_blocks(items.size(), num_threads, [&](unsigned int t, std::size_t begin, std::size_t end) noexcept {
+        auto& block = blocks[t];
+        block.reserve((end - begin) * 16);
+        for (auto i = begin; i < end; ++i) {
+            append_number(block, items[i].value);
+            block += ' ';
+            append_number(block, items[i].weight);
+            block += '\n';
         }
     });
-    std::cout << std::fixed << std::setprecision(6);
-    double c = n * (b - a) / f;
-    std::cout << n << '\n' << c << "\n\n";
-    for (auto e : elements) {
-        std::cout << e.value << ' ' << e.weight << '\n';
+    for (auto const& block : blocks) {
+        out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    }
+    out << '\n';
+    if (!out) {
+        throw std::runtime_error{"Write failed"};
+    }
+}
+
+template <typename WeightType = long long, typename ValueType = WeightType>
+void generate_knapsack_instance(Parameters const& params, unsigned int num_threads,
+                                std::filesystem::path const& output_file, bool binary) {
+    using generator_type = Generator<WeightType, ValueType>;
+    generator_type generator{params};
+    std::vector<typename generator_type::item_type> items(static_cast<std::size_t>(params.n));
+    std::vector<WeightType> total_weights(num_threads, WeightType{});
+    parallel_blocks(items.size(), num_threads, [&](unsigned int t, std::size_t begin, std::size_t end) noexcept {
+        WeightType total{};
+        for (auto i = begin; i < end; ++i) {
+            items[i] = generator.item(i);
+            total += items[i].weight;
+        }
+        total_weights[t] = total;
+    });
+    auto capacity = generator.capacity(std::accumulate(total_weights.begin(), total_weights.end(), WeightType{}));
+    if (binary) {
+        typename generator_type::instance_type{std::move(items), capacity, num_threads}.write_binary(output_file);
+    } else if (output_file.empty()) {
+        write_text(items, capacity, num_threads, std::cout);
+    } else {
+        std::ofstream out{output_file, std::ios::binary};
+        if (!out) {
+            throw std::runtime_error{"Could not open file"};
+        }
+        write_text(items, capacity, num_threads, out);
     }
-    std::cout << '\n';
 }
 
 int main(int argc, char* argv[]) {
     cxxopts::Options options("Knapsack generator", "Generate knapsack instances");
-    long long n = 1000;
-    double a = 1000;
-    double b = 100000;
-    double l = 10000;
-    double u = 12500;
-    double f = 2;
-    unsigned long s = 1;
+    Parameters params{};
+    std::string instance_class = "offset";
+    unsigned int num_threads = 4;
+    std::filesystem::path output_file;
+    bool binary = false;
     bool use_doubles = false;
     // clang-format off
     options.add_options()
-      ("n,num-elements", "Number of elements", cxxopts::value<long long>(n), "NUMBER")
-      ("a,weight-min", "Min weight", cxxopts::value<double>(a), "NUMBER")
-      ("b,weight-max", "Max weight", cxxopts::value<double>(b), "NUMBER")
-      ("l,p-min", "Min add to profits", cxxopts::value<double>(l), "NUMBER")
-      ("u,p-max", "Max add to profits", cxxopts::value<double>(u), "NUMBER")
-      ("f,capacity-divide", "Fraction of weights", cxxopts::value<double>(f), "NUMBER")
-      ("s,seed", "Seed", cxxopts::value<unsigned long>(s), "NUMBER")
+      ("t,type", "Instance class (offset, uncorrelated, weakly, strongly, inverse-strongly, almost-strongly, subset-sum, similar-weights, spanner-uncorrelated, spanner-weakly, spanner-strongly, profit-ceiling, circle)", cxxopts::value<std::string>(instance_class), "CLASS")
+      ("n,num-elements", "Number of elements", cxxopts::value<long long>(params.n), "NUMBER")
+      ("a,weight-min", "Min weight (offset class)", cxxopts::value<double>(params.a), "NUMBER")
+      ("b,weight-max", "Max weight (offset class)", cxxopts::value<double>(params.b), "NUMBER")
+      ("l,p-min", "Min add to profits (offset class)", cxxopts::value<double>(params.l), "NUMBER")
+      ("u,p-max", "Max add to profits (offset class)", cxxopts::value<double>(params.u), "NUMBER")
+      ("r,range", "Data range of the other classes, weights are drawn from [1, range]", cxxopts::value<double>(params.range), "NUMBER")
+      ("f,capacity-divide", "Capacity is the total weight divided by this (offset class: num-elements * (weight-max - weight-min) divided by this)", cxxopts::value<double>(params.f), "NUMBER")
+      ("spanner-size", "Number of spanner items", cxxopts::value<long long>(params.spanner_size), "NUMBER")
+      ("spanner-multiplier", "Largest multiplier of the spanner items", cxxopts::value<long long>(params.spanner_multiplier), "NUMBER")
+      ("profit-ceiling", "Values are the weights rounded up to a multiple of this", cxxopts::value<double>(params.profit_ceiling), "NUMBER")
+      ("circle", "Scale of the circle class values", cxxopts::value<double>(params.circle), "NUMBER")
+      ("s,seed", "Seed", cxxopts::value<unsigned long>(params.seed), "NUMBER")
+      ("j,threads", "The number of threads", cxxopts::value<unsigned int>(num_threads), "NUMBER")
+      ("o,output", "Write to this file instead of stdout", cxxopts::value<std::filesystem::path>(output_file), "PATH")
+      ("binary", "Write the sorted binary format (requires --output)", cxxopts::value<bool>(binary))
       ("d,doubles", "Use doubles", cxxopts::value<bool>(use_doubles)->default_value("false"), "Use doubles")
       ("h,help", "Print this help");
     // clang-format on
@@ -72,10 +354,30 @@ int main(int argc, char* argv[]) {
         std::cerr << e.what() << std::endl;
         return 1;
     }
-    if (use_doubles) {
-        generate_knapsack_instance<double>(n, a, b, l, u, f, s);
-    } else {
-        generate_knapsack_instance<long long, long long>(n, a, b, l, u, f, s);
+    auto it = std::find_if(instance_classes.begin(), instance_classes.end(),
+                           [&](auto const& entry) { return instance_class == entry.first; });
+    if (it == instance_classes.end()) {
+        std::cerr << "Error: Unknown instance class " << instance_class << std::endl;
+        return 1;
+    }
+    params.instance_class = it->second;
+    if (params.n < 0 || num_threads == 0 || params.f <= 0) {
+        std::cerr << "Error: Invalid parameters" << std::endl;
+        return 1;
+    }
+    if (binary && output_file.empty()) {
+        std::cerr << "Error: The binary format requires an output file" << std::endl;
+        return 1;
+    }
+    try {
+        if (use_doubles) {
+            generate_knapsack_instance<double>(params, num_threads, output_file, binary);
+        } else {
+            generate_knapsack_instance<long long, long long>(params, num_threads, output_file, binary);
+        }
+    } catch (std::runtime_error const& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
     }
     return 0;
 }
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "incumbent.hpp"
+#include "task.hpp"
+#include "termination_detection.hpp"
+#include "wrapper/util.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Parallel best-first branch and bound for maximization problems over a relaxed priority queue. The problem is a
+// policy class with
+//   value_type, node_type                   objective and subproblem types
+//   value_type initial_solution()           objective of a known feasible solution, called once before the search
+//   void root(Context&)                     pushes the root subproblems, called by one thread
+//   value_type upper_bound(node_type)       bound used to prune popped nodes against the incumbent
+//   void branch(node_type, Context&)        reports solutions with improve() and pushes children with push()
+//   encode(node_type) / decode(entry)       conversion to and from the value type of the priority queue
+//   value_type key_bound(key)               upper bound of all nodes with at most this key, only needed for early
+//                                           termination
+// Each thread uses its own problem object, which can thus keep thread-local statistics.
+//
+// With early termination, threads stop popping as soon as the queue's best-key bound (see wrapper/util.hpp) is no
+// better than the incumbent, so the remaining nodes are not drained just to be pruned. Threads still processing a
+// node keep the others from terminating, and the nodes they push raise the bound again.
+//
+// Tracking the queue size keeps an exact count of the queued nodes in one shared counter, which costs an atomic
+// update per push and pop, and reports its peak.
+namespace branch_and_bound {
+
+template <typename Value>
+struct ThreadStats {
+    long long pushed_nodes{0};
+    long long processed_nodes{0};
+    long long ignored_nodes{0};
+    typename Incumbent<Value>::Stats incumbent{};
+};
+
+template <typename Value>
+ThreadStats<Value> accumulate(ThreadStats<Value> accum, ThreadStats<Value> const& e) noexcept {
+    accum.pushed_nodes += e.pushed_nodes;
+    accum.processed_nodes += e.processed_nodes;
+    accum.ignored_nodes += e.ignored_nodes;
+    accum.incumbent.global_updates += e.incumbent.global_updates;
+    accum.incumbent.local_updates += e.incumbent.local_updates;
+    accum.incumbent.transfers += e.incumbent.transfers;
+    accum.incumbent.refreshes += e.incumbent.refreshes;
+    return accum;
+}
+
+template <typename Value>
+struct SharedData {
+    Incumbent<Value> incumbent;
+    // Threads sharing an incumbent slot, the cores of a NUMA node with affinity::NUMA
+    int threads_per_slot;
+    // Requires a queue with best_key_bound()
+    bool early_termination = false;
+    bool track_queue_size = false;
+    termination_detection::Data termination_detection_data{};
+    alignas(L1_CACHE_LINESIZE) std::atomic<long long> queue_size{0};
+    std::atomic<long long> peak_queue_size{0};
+
+    SharedData(int num_threads, int threads_per_slot_, unsigned int refresh_interval)
+        : incumbent{static_cast<std::size_t>((num_threads + threads_per_slot_ - 1) / threads_per_slot_),
+                    refresh_interval},
+          threads_per_slot{threads_per_slot_} {
+    }
+};
+
+// What a thread's problem object sees of the search
+template <typename Problem, typename Handle>
+class Context {
+   public:
+    using value_type = typename Problem::value_type;
+    using node_type = typename Problem::node_type;
+
+   private:
+    Problem& problem_;
+    Handle& handle_;
+    typename Incumbent<value_type>::View& incumbent_;
+    ThreadStats<value_type>& stats_;
+    SharedData<value_type>& data_;
+
+   public:
+    Context(Problem& problem, Handle& handle, typename Incumbent<value_type>::View& incumbent,
+            ThreadStats<value_type>& stats, SharedData<value_type>& data) noexcept
+        : problem_{problem}, handle_{handle}, incumbent_{incumbent}, stats_{stats}, data_{data} {
+    }
+
+    // The cached incumbent, possibly slightly stale
+    value_type best() noexcept {
+        return incumbent_.get();
+    }
+
+    // Reports a feasible solution and returns the best known value afterwards
+    value_type improve(value_type value) noexcept {
+        return incumbent_.update(value);
+    }
+
+    void push(node_type const& node) {
+        if (data_.track_queue_size) {
+            // Counted before the push, so that the count never drops below zero
+            auto size = data_.queue_size.fetch_add(1, std::memory_order_relaxed) + 1;
+            auto peak = data_.peak_queue_size.load(std::memory_order_relaxed);
+            while (size > peak &&
+                   !data_.peak_queue_size.compare_exchange_weak(peak, size, std::memory_order_relaxed)) {
+            }
+        }
+        handle_.push(problem_.encode(node));
+        ++stats_.pushed_nodes;
+    }
+
+    // Called for every node popped from the queue
+    void popped() noexcept {
+        if (data_.track_queue_size) {
+            data_.queue_size.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    Problem& problem() noexcept {
+        return problem_;
+    }
+
+    Handle& handle() noexcept {
+        return handle_;
+    }
+
+    ThreadStats<value_type>& stats() noexcept {
+        return stats_;
+    }
+};
+
+template <typename Problem, typename Handle, typename PQ>
+bool process_node(Context<Problem, Handle>& context, PQ const& pq, bool early_termination) {
+    if constexpr (wrapper::util::has_best_key_bound_v<PQ>) {
+        if (early_termination) {
+            auto bound = pq.best_key_bound();
+            if (!bound || context.problem().key_bound(*bound) <= context.best()) {
+                return false;
+            }
+        }
+    }
+    auto entry = context.handle().try_pop();
+    if (!entry) {
+        return false;
+    }
+    context.popped();
+    ++context.stats().processed_nodes;
+    auto node = context.problem().decode(*entry);
+    if (context.problem().upper_bound(node) <= context.best()) {
+        ++context.stats().ignored_nodes;
+        return true;
+    }
+    context.problem().branch(node, context);
+    return true;
+}
+
+// `data` has to be fresh for every search
+template <typename Problem, typename PQ>
+ThreadStats<typename Problem::value_type> run_thread(task::Control tc, PQ& pq, Problem& problem,
+                                                     SharedData<typename Problem::value_type>& data) {
+    using handle_type = typename PQ::handle_type;
+    ThreadStats<typename Problem::value_type> stats;
+    handle_type handle = pq.get_handle();
+    if (tc.id() == 0) {
+        data.incumbent.reset(problem.initial_solution());
+    }
+    tc.synchronize();
+    auto incumbent = data.incumbent.view(static_cast<std::size_t>(tc.id() / data.threads_per_slot));
+    Context<Problem, handle_type> context{problem, handle, incumbent, stats, data};
+    if (tc.id() == 0) {
+        problem.root(context);
+    }
+    while (termination_detection::try_do(tc.num_threads(), data.termination_detection_data,
+                                         [&]() { return process_node(context, pq, data.early_termination); })) {
+    }
+    stats.incumbent = incumbent.stats();
+    tc.synchronize();
+    return stats;
+}
+
+}  // namespace branch_and_bound
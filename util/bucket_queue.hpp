@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// Dial's bucket queue for monotone integer keys: all queued keys lie in [current, current + max_key_range], so a
+// circular array of max_key_range + 1 buckets holds every key in its own bucket.
+template <typename Value, typename KeyOfValue>
+class BucketQueue {
+    std::vector<std::vector<Value>> buckets_;
+    std::size_t current_{0};
+    std::size_t size_{0};
+
+    [[nodiscard]] std::size_t bucket_index(std::size_t k) const noexcept {
+        return k % buckets_.size();
+    }
+
+    void advance() noexcept {
+        assert(size_ > 0);
+        while (buckets_[bucket_index(current_)].empty()) {
+            ++current_;
+        }
+    }
+
+   public:
+    explicit BucketQueue(std::size_t max_key_range) : buckets_(max_key_range + 1) {
+    }
+
+    void push(Value const& value) {
+        auto k = static_cast<std::size_t>(KeyOfValue::get(value));
+        assert(k >= current_ && k - current_ < buckets_.size());
+        buckets_[bucket_index(k)].push_back(value);
+        ++size_;
+    }
+
+    Value const& top() noexcept {
+        advance();
+        return buckets_[bucket_index(current_)].back();
+    }
+
+    void pop() noexcept {
+        advance();
+        buckets_[bucket_index(current_)].pop_back();
+        --size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_;
+    }
+};
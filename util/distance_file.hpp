@@ -0,0 +1,123 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Binary distance files consist of the number of nodes followed by one distance per node, all as native 64-bit
+// integers
+namespace distance_file {
+
+using distance_type = std::int64_t;
+
+static constexpr std::size_t write_buffer_entries = 1 << 16;
+
+namespace detail {
+
+inline void write_all(int fd, char const* data, std::size_t size) {
+    while (size > 0) {
+        auto written = ::write(fd, data, size);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error{std::string{"Write failed: "} + std::strerror(errno)};
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+}  // namespace detail
+
+// `get(i)` has to return the distance of node i
+template <typename DistanceAt>
+void write_binary(std::filesystem::path const& file, std::size_t num_nodes, DistanceAt get) {
+    int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        throw std::runtime_error{"Could not open file"};
+    }
+    try {
+        std::vector<distance_type> buffer;
+        buffer.reserve(write_buffer_entries);
+        buffer.push_back(static_cast<distance_type>(num_nodes));
+        for (std::size_t i = 0; i < num_nodes; ++i) {
+            if (buffer.size() == write_buffer_entries) {
+                detail::write_all(fd, reinterpret_cast<char const*>(buffer.data()),
+                                  buffer.size() * sizeof(distance_type));
+                buffer.clear();
+            }
+            buffer.push_back(static_cast<distance_type>(get(i)));
+        }
+        detail::write_all(fd, reinterpret_cast<char const*>(buffer.data()), buffer.size() * sizeof(distance_type));
+    } catch (std::runtime_error const&) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) == -1) {
+        throw std::runtime_error{"Could not close file"};
+    }
+}
+
+// Read-only view of a binary distance file, pages are only loaded on access
+class MappedDistances {
+    void* addr_ = nullptr;
+    std::size_t length_ = 0;
+    distance_type const* distances_ = nullptr;
+    std::size_t num_nodes_ = 0;
+
+   public:
+    explicit MappedDistances(std::filesystem::path const& file) {
+        int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd == -1) {
+            throw std::runtime_error{"Could not open file"};
+        }
+        struct stat sb {};
+        if (::fstat(fd, &sb) == -1) {
+            ::close(fd);
+            throw std::runtime_error{"Could not get file size"};
+        }
+        length_ = static_cast<std::size_t>(sb.st_size);
+        if (length_ < sizeof(distance_type) || length_ % sizeof(distance_type) != 0) {
+            ::close(fd);
+            throw std::runtime_error{"Invalid file size"};
+        }
+        addr_ = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr_ == MAP_FAILED) {
+            throw std::runtime_error{"mmap failed"};
+        }
+        auto const* data = static_cast<distance_type const*>(addr_);
+        num_nodes_ = static_cast<std::size_t>(data[0]);
+        if (num_nodes_ != length_ / sizeof(distance_type) - 1) {
+            ::munmap(addr_, length_);
+            throw std::runtime_error{"Number of nodes does not match file size"};
+        }
+        distances_ = data + 1;
+    }
+
+    MappedDistances(MappedDistances const&) = delete;
+    MappedDistances& operator=(MappedDistances const&) = delete;
+
+    ~MappedDistances() {
+        ::munmap(addr_, length_);
+    }
+
+    [[nodiscard]] std::size_t num_nodes() const noexcept {
+        return num_nodes_;
+    }
+
+    distance_type operator[](std::size_t i) const noexcept {
+        return distances_[i];
+    }
+};
+
+}  // namespace distance_file
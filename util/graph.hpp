@@ -19,6 +19,9 @@ struct Graph {
     };
     std::vector<std::size_t> nodes;
     std::vector<Edge> edges;
+    // Structure-of-arrays copy of `edges`, only filled by split_edges()
+    std::vector<std::size_t> edge_targets;
+    std::vector<weight_type> edge_weights;
 
     Graph() = default;
     Graph(std::filesystem::path const& graph_file) {
@@ -131,6 +134,66 @@ struct Graph {
         }
     }
 
+    // Returns the graph with all edges reversed
+    [[nodiscard]] Graph reversed() const {
+        Graph reverse;
+        reverse.nodes.assign(nodes.size(), 0);
+        reverse.edges.resize(edges.size());
+        for (auto const& edge : edges) {
+            ++reverse.nodes[edge.target + 1];
+        }
+        if (reverse.nodes.size() > 1) {
+            std::exclusive_scan(reverse.nodes.begin() + 1, reverse.nodes.end(), reverse.nodes.begin() + 1, 0);
+        }
+        for (std::size_t source = 0; source < num_nodes(); ++source) {
+            for (auto i = nodes[source]; i < nodes[source + 1]; ++i) {
+                reverse.edges[reverse.nodes[edges[i].target + 1]++] = Edge{source, edges[i].weight};
+            }
+        }
+        return reverse;
+    }
+
+    void split_edges() {
+        edge_targets.resize(edges.size());
+        edge_weights.resize(edges.size());
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+            edge_targets[i] = edges[i].target;
+            edge_weights[i] = edges[i].weight;
+        }
+    }
+
+    // Calls `f(target, weight)` for every edge of `node`
+    template <typename F>
+    void for_each_edge(std::size_t node, F&& f) const {
+        for (auto i = nodes[node]; i < nodes[node + 1]; ++i) {
+            f(edges[i].target, edges[i].weight);
+        }
+    }
+
+    // Returns the source node of the edge at index `edge`
+    [[nodiscard]] std::size_t source(std::size_t edge) const noexcept {
+        assert(edge < edges.size());
+        return static_cast<std::size_t>(std::upper_bound(nodes.begin(), nodes.end(), edge) - nodes.begin() - 1);
+    }
+
+    // Returns the index of an edge from `source` to `target` with the given weight, or num_edges() if there is none
+    [[nodiscard]] std::size_t find_edge(std::size_t source, std::size_t target, weight_type weight) const noexcept {
+        for (auto i = nodes[source]; i < nodes[source + 1]; ++i) {
+            if (edges[i].target == target && edges[i].weight == weight) {
+                return i;
+            }
+        }
+        return edges.size();
+    }
+
+    // Keeps the structure-of-arrays copy in sync
+    void set_weight(std::size_t edge, weight_type weight) noexcept {
+        edges[edge].weight = weight;
+        if (!edge_weights.empty()) {
+            edge_weights[edge] = weight;
+        }
+    }
+
     [[nodiscard]] std::size_t num_nodes() const noexcept {
         return nodes.empty() ? 0 : nodes.size() - 1;
     }
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// Grid graph with up to three dimensions whose edges are computed from the node id, so only the per-node data of
+// the solver has to be stored. Nodes are connected to their neighbors along each axis, wrapping around in a torus.
+// Edge weights are derived from a hash of the unordered node pair, so the graph is symmetric.
+class GridGraph {
+   public:
+    using weight_type = long long;
+    static constexpr std::size_t max_dimensions = 3;
+
+   private:
+    std::array<std::size_t, max_dimensions> extent_{1, 1, 1};
+    std::array<std::size_t, max_dimensions> stride_{1, 1, 1};
+    std::size_t num_nodes_ = 1;
+    bool torus_ = false;
+    weight_type max_weight_ = 1;
+    std::uint64_t seed_ = 0;
+
+    static constexpr std::uint64_t mix(std::uint64_t x) noexcept {
+        x += 0x9e3779b97f4a7c15;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+        return x ^ (x >> 31);
+    }
+
+   public:
+    GridGraph(std::array<std::size_t, max_dimensions> extent, bool torus, weight_type max_weight, std::uint64_t seed)
+        : extent_{extent}, torus_{torus}, max_weight_{max_weight}, seed_{seed} {
+        if (max_weight < 1) {
+            throw std::runtime_error{"Maximum weight must be positive"};
+        }
+        num_nodes_ = 1;
+        for (std::size_t d = 0; d < max_dimensions; ++d) {
+            if (extent_[d] == 0) {
+                throw std::runtime_error{"Grid extents must be positive"};
+            }
+            if (extent_[d] > std::numeric_limits<std::size_t>::max() / num_nodes_) {
+                throw std::runtime_error{"Grid too large"};
+            }
+            stride_[d] = num_nodes_;
+            num_nodes_ *= extent_[d];
+        }
+    }
+
+    // Parses extents like "1000x1000" or "100x100x100"
+    static std::array<std::size_t, max_dimensions> parse_extent(std::string const& str) {
+        std::array<std::size_t, max_dimensions> extent{1, 1, 1};
+        auto const* it = str.data();
+        auto const* end = str.data() + str.size();
+        for (std::size_t d = 0; d < max_dimensions; ++d) {
+            auto res = std::from_chars(it, end, extent[d]);
+            if (res.ec != std::errc{}) {
+                throw std::runtime_error{"Failed to parse grid extent"};
+            }
+            it = res.ptr;
+            if (it == end) {
+                return extent;
+            }
+            if (*it != 'x') {
+                break;
+            }
+            ++it;
+        }
+        throw std::runtime_error{"Invalid grid format"};
+    }
+
+    [[nodiscard]] weight_type weight(std::size_t u, std::size_t v) const noexcept {
+        auto lo = static_cast<std::uint64_t>(u < v ? u : v);
+        auto hi = static_cast<std::uint64_t>(u < v ? v : u);
+        return 1 + static_cast<weight_type>(mix(mix(seed_ ^ lo) ^ hi) % static_cast<std::uint64_t>(max_weight_));
+    }
+
+    // Calls `f(target, weight)` for every edge of `node`
+    template <typename F>
+    void for_each_edge(std::size_t node, F&& f) const {
+        for (std::size_t d = 0; d < max_dimensions; ++d) {
+            if (extent_[d] == 1) {
+                continue;
+            }
+            auto coordinate = (node / stride_[d]) % extent_[d];
+            if (coordinate > 0) {
+                f(node - stride_[d], weight(node, node - stride_[d]));
+            } else if (torus_) {
+                auto target = node + (extent_[d] - 1) * stride_[d];
+                f(target, weight(node, target));
+            }
+            if (coordinate + 1 < extent_[d]) {
+                f(node + stride_[d], weight(node, node + stride_[d]));
+            } else if (torus_) {
+                auto target = node - (extent_[d] - 1) * stride_[d];
+                f(target, weight(node, target));
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t num_nodes() const noexcept {
+        return num_nodes_;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, GridGraph const& graph) {
+        auto dimensions = max_dimensions;
+        while (dimensions > 1 && graph.extent_[dimensions - 1] == 1) {
+            --dimensions;
+        }
+        out << graph.extent_[0];
+        for (std::size_t d = 1; d < dimensions; ++d) {
+            out << 'x' << graph.extent_[d];
+        }
+        return out << (graph.torus_ ? " torus" : " grid") << ", weights in [1, " << graph.max_weight_ << ']';
+    }
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+// Best known solution of a maximization problem, shared without a single contended cache line. Threads prune with
+// a cached copy that is refreshed from their NUMA node's slot every `refresh_interval` reads. Improvements are
+// written through to the NUMA slot and, if they improve it, to the global slot. On refresh, a thread also pulls a
+// better global value into its NUMA slot, so improvements reach other nodes after at most `refresh_interval` reads
+// of any thread there. Values only grow, so the value itself serves as version and a stale copy only prunes less.
+template <typename T>
+class Incumbent {
+   public:
+    struct Stats {
+        // Improvements of the global slot
+        long long global_updates = 0;
+        // Improvements of a NUMA slot by a local thread
+        long long local_updates = 0;
+        // Global values copied into a NUMA slot
+        long long transfers = 0;
+        long long refreshes = 0;
+    };
+
+   private:
+    struct alignas(L1_CACHE_LINESIZE) Slot {
+        std::atomic<T> value{};
+    };
+
+    Slot global_;
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t num_slots_;
+    unsigned int refresh_interval_;
+
+    // Returns true if `slot` was improved, otherwise sets `value` to the better value of the slot
+    static bool raise(std::atomic<T>& slot, T& value) noexcept {
+        auto current = slot.load(std::memory_order_relaxed);
+        while (value > current) {
+            if (slot.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        value = current;
+        return false;
+    }
+
+   public:
+    class View {
+        Incumbent* incumbent_;
+        std::atomic<T>* slot_;
+        T cached_;
+        unsigned int reads_ = 0;
+        Stats stats_;
+
+       public:
+        View(Incumbent& incumbent, std::size_t slot) noexcept
+            : incumbent_{&incumbent},
+              slot_{&incumbent.slots_[slot % incumbent.num_slots_].value},
+              cached_{slot_->load(std::memory_order_relaxed)} {
+        }
+
+        T get() noexcept {
+            if (++reads_ >= incumbent_->refresh_interval_) {
+                refresh();
+            }
+            return cached_;
+        }
+
+        // Returns the best known value after the update
+        T update(T value) noexcept {
+            if (value <= cached_) {
+                return cached_;
+            }
+            if (raise(*slot_, value)) {
+                ++stats_.local_updates;
+                if (raise(incumbent_->global_.value, value)) {
+                    ++stats_.global_updates;
+                }
+            }
+            cached_ = value;
+            return cached_;
+        }
+
+        T refresh() noexcept {
+            reads_ = 0;
+            ++stats_.refreshes;
+            auto global = incumbent_->global_.value.load(std::memory_order_relaxed);
+            if (raise(*slot_, global)) {
+                ++stats_.transfers;
+            }
+            if (global > cached_) {
+                cached_ = global;
+            }
+            return cached_;
+        }
+
+        [[nodiscard]] Stats const& stats() const noexcept {
+            return stats_;
+        }
+    };
+
+    Incumbent(std::size_t num_slots, unsigned int refresh_interval)
+        : slots_{new Slot[num_slots]}, num_slots_{num_slots}, refresh_interval_{refresh_interval} {
+        if (num_slots == 0 || refresh_interval == 0) {
+            throw std::runtime_error{"Invalid incumbent configuration"};
+        }
+    }
+
+    // Not thread-safe, views have to be created afterwards
+    void reset(T value) noexcept {
+        global_.value.store(value, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < num_slots_; ++i) {
+            slots_[i].value.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    View view(std::size_t slot) noexcept {
+        return View{*this, slot};
+    }
+
+    [[nodiscard]] T load() const noexcept {
+        return global_.value.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::size_t num_slots() const noexcept {
+        return num_slots_;
+    }
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+// Key transformations applied between the applications and the priority queues to reduce the number of distinct
+// priority levels
+namespace key_transform {
+
+// Maps integer keys to priority levels, either by dropping the lowest bits or by dividing by delta
+class Coarsening {
+    unsigned int shift_ = 0;
+    unsigned long delta_ = 1;
+
+   public:
+    Coarsening() = default;
+
+    static constexpr unsigned int max_shift = 63;
+
+    static Coarsening by_shift(unsigned int shift) {
+        if (shift > max_shift) {
+            throw std::invalid_argument{"Coarsening shift must be less than 64"};
+        }
+        Coarsening c;
+        c.shift_ = shift;
+        return c;
+    }
+
+    static Coarsening by_delta(unsigned long delta) noexcept {
+        Coarsening c;
+        c.delta_ = delta;
+        return c;
+    }
+
+    // Coarsening from the command line options, at most one of which may be set
+    static Coarsening from_options(unsigned int shift, unsigned long delta) {
+        if (shift > 0 && delta > 1) {
+            throw std::invalid_argument{"Coarsening shift and delta are mutually exclusive"};
+        }
+        return delta > 1 ? by_delta(delta) : by_shift(shift);
+    }
+
+    [[nodiscard]] bool enabled() const noexcept {
+        return shift_ > 0 || delta_ > 1;
+    }
+
+    // Number of keys mapped to the same level
+    [[nodiscard]] unsigned long level_width() const noexcept {
+        return delta_ > 1 ? delta_ : 1UL << shift_;
+    }
+
+    unsigned long operator()(unsigned long key) const noexcept {
+        return delta_ > 1 ? key / delta_ : key >> shift_;
+    }
+
+    // The largest key mapped to `level`
+    [[nodiscard]] unsigned long max_key(unsigned long level) const noexcept {
+        return (level + 1) * level_width() - 1;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, Coarsening const& c) {
+        if (!c.enabled()) {
+            return out << "none";
+        }
+        if (c.delta_ > 1) {
+            return out << "delta " << c.delta_;
+        }
+        return out << "shift " << c.shift_ << " (" << c.level_width() << " keys per level)";
+    }
+};
+
+// Rounds a nonnegative double up to the next value whose `dropped_bits` lowest mantissa bits are zero. The bit
+// pattern of nonnegative doubles is ordered like their values, so this preserves the order of keys, and the result
+// is never smaller than the input and thus still valid as an upper bound.
+inline double truncate_up(double key, unsigned int dropped_bits) noexcept {
+    static_assert(sizeof(double) == sizeof(unsigned long));
+    if (dropped_bits == 0) {
+        return key;
+    }
+    unsigned long bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    unsigned long mask = (1UL << dropped_bits) - 1;
+    if ((bits & mask) != 0) {
+        bits = (bits | mask) + 1;
+    }
+    std::memcpy(&key, &bits, sizeof(key));
+    return key;
+}
+
+// Maps a double to an unsigned integer with the same order, so that floating-point priorities can be used with
+// integer-keyed queues. Negative values have all bits flipped, nonnegative values only the sign bit.
+inline unsigned long to_ordered_bits(double key) noexcept {
+    static_assert(sizeof(double) == sizeof(unsigned long));
+    unsigned long bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    return (bits >> 63) != 0 ? ~bits : bits | (1UL << 63);
+}
+
+inline double from_ordered_bits(unsigned long bits) noexcept {
+    bits = (bits >> 63) != 0 ? bits & ~(1UL << 63) : ~bits;
+    double key;
+    std::memcpy(&key, &bits, sizeof(key));
+    return key;
+}
+
+}  // namespace key_transform
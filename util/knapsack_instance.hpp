@@ -1,16 +1,63 @@
 #pragma once
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <iostream>
 
+#if defined __AVX512F__ || defined __AVX2__
+#include <immintrin.h>
+#endif
 #include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <charconv>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+// How the critical item, the first item that does not fit anymore when packing greedily, is searched
+enum class CriticalSearch { linear, binary, galloping, simd };
+
+inline char const* to_string(CriticalSearch search) noexcept {
+    switch (search) {
+        case CriticalSearch::linear:
+            return "linear";
+        case CriticalSearch::binary:
+            return "binary";
+        case CriticalSearch::galloping:
+            return "galloping";
+        case CriticalSearch::simd:
+            return "simd";
+    }
+    return "unknown";
+}
+
+// Upper bound of a subproblem. Tighter bounds prune more nodes but take more work per node: Martello and Toth's U2
+// looks at two more items than Dantzig's bound, the Müller-Merbach bound scans all items of the subproblem.
+enum class BoundPolicy { dantzig, martello_toth, mueller_merbach };
+
+inline char const* to_string(BoundPolicy bound) noexcept {
+    switch (bound) {
+        case BoundPolicy::dantzig:
+            return "dantzig";
+        case BoundPolicy::martello_toth:
+            return "martello-toth";
+        case BoundPolicy::mueller_merbach:
+            return "mueller-merbach";
+    }
+    return "unknown";
+}
+
 template <typename WeightType = long long, typename ValueType = WeightType>
 class KnapsackInstance {
    public:
@@ -19,57 +66,206 @@ class KnapsackInstance {
         ValueType value;
     };
 
+    struct Bounds {
+        ValueType lower;
+        ValueType upper;
+        // Position of the critical item, size() if all items fit
+        std::size_t critical;
+    };
+
+    struct Reduction;
+
    private:
-    std::vector<Item> prefix_sum_;
+    // Prefix sums of the items sorted by efficiency, stored as separate arrays for vectorized scans
+    std::vector<WeightType> prefix_weights_;
+    std::vector<ValueType> prefix_values_;
     WeightType capacity_{};
 
+    static constexpr char binary_magic[8] = {'K', 'N', 'A', 'P', 'B', 'I', 'N', '1'};
+    static constexpr std::size_t parallel_sort_threshold = 1 << 16;
+
+    struct BinaryHeader {
+        char magic[8];
+        std::uint64_t num_items;
+        std::uint32_t weight_type;
+        std::uint32_t value_type;
+    };
+
+    // Identifies the number type of a binary file by its size and whether it is a floating point type
+    template <typename T>
+    static constexpr std::uint32_t type_tag() noexcept {
+        return static_cast<std::uint32_t>(sizeof(T)) | (std::is_floating_point_v<T> ? 0x100U : 0U);
+    }
+
+    template <typename T>
+    static char const* parse_number(char const* it, char const* end, T& number, char const* error) {
+        while (it != end && std::isspace(static_cast<unsigned char>(*it)) != 0) {
+            ++it;
+        }
+        auto res = std::from_chars(it, end, number);
+        if (res.ec != std::errc{}) {
+            throw std::runtime_error{error};
+        }
+        return res.ptr;
+    }
+
+    // Sorts halves in parallel and merges them
+    template <typename Iterator, typename Compare>
+    static void parallel_sort(Iterator first, Iterator last, Compare comp, unsigned int num_threads) {
+        if (num_threads <= 1 || static_cast<std::size_t>(last - first) < parallel_sort_threshold) {
+            std::sort(first, last, comp);
+            return;
+        }
+        auto middle = first + (last - first) / 2;
+        std::thread worker{[=]() { parallel_sort(first, middle, comp, num_threads / 2); }};
+        parallel_sort(middle, last, comp, num_threads - num_threads / 2);
+        worker.join();
+        std::inplace_merge(first, middle, last, comp);
+    }
+
+    // Descending efficiency, compared by cross multiplication instead of dividing. Ties are broken by weight, so the
+    // prefix sums do not depend on the number of sorting threads.
+    static bool more_efficient(Item const& lhs, Item const& rhs) noexcept {
+        if constexpr (std::is_integral_v<WeightType> && std::is_integral_v<ValueType>) {
+            __extension__ typedef __int128 wide_type;
+            auto lhs_product = static_cast<wide_type>(lhs.value) * rhs.weight;
+            auto rhs_product = static_cast<wide_type>(rhs.value) * lhs.weight;
+            return lhs_product > rhs_product || (lhs_product == rhs_product && lhs.weight < rhs.weight);
+        } else {
+            auto lhs_product = static_cast<double>(lhs.value) * static_cast<double>(rhs.weight);
+            auto rhs_product = static_cast<double>(rhs.value) * static_cast<double>(lhs.weight);
+            return lhs_product > rhs_product || (lhs_product == rhs_product && lhs.weight < rhs.weight);
+        }
+    }
+
+    void read_text(char const* it, char const* end, unsigned int num_threads) {
+        std::size_t n{};
+        it = parse_number(it, end, n, "Could not get number of items");
+        it = parse_number(it, end, capacity_, "Could not get capacity");
+        // The generator writes the capacity with a fractional part, integral capacities are rounded down
+        if constexpr (std::is_integral_v<WeightType>) {
+            if (it != end && *it == '.') {
+                do {
+                    ++it;
+                } while (it != end && std::isdigit(static_cast<unsigned char>(*it)) != 0);
+            }
+        }
+        std::vector<Item> items(n);
+        for (auto& item : items) {
+            it = parse_number(it, end, item.value, "Could not read item value");
+            it = parse_number(it, end, item.weight, "Could not read item weight");
+        }
+        build(std::move(items), num_threads);
+    }
+
+    // Sorts the items by efficiency and stores their prefix sums
+    void build(std::vector<Item> items, unsigned int num_threads) {
+        auto n = items.size();
+        parallel_sort(items.begin(), items.end(), more_efficient, num_threads);
+        prefix_weights_.resize(n + 1);
+        prefix_values_.resize(n + 1);
+        prefix_weights_[0] = WeightType{};
+        prefix_values_[0] = ValueType{};
+        for (std::size_t i = 0; i < n; ++i) {
+            prefix_weights_[i + 1] = prefix_weights_[i] + items[i].weight;
+            prefix_values_[i + 1] = prefix_values_[i] + items[i].value;
+        }
+    }
+
+    void read_binary(char const* begin, char const* end) {
+        BinaryHeader header{};
+        if (static_cast<std::size_t>(end - begin) < sizeof(header) + sizeof(capacity_)) {
+            throw std::runtime_error{"Truncated binary instance"};
+        }
+        std::memcpy(&header, begin, sizeof(header));
+        if (header.weight_type != type_tag<WeightType>() || header.value_type != type_tag<ValueType>()) {
+            throw std::runtime_error{"Binary instance has different number types"};
+        }
+        auto n = static_cast<std::size_t>(header.num_items);
+        if (static_cast<std::size_t>(end - begin) !=
+            sizeof(header) + sizeof(capacity_) + (n + 1) * (sizeof(WeightType) + sizeof(ValueType))) {
+            throw std::runtime_error{"Number of items does not match file size"};
+        }
+        auto const* it = begin + sizeof(header);
+        std::memcpy(&capacity_, it, sizeof(capacity_));
+        it += sizeof(capacity_);
+        prefix_weights_.resize(n + 1);
+        std::memcpy(prefix_weights_.data(), it, (n + 1) * sizeof(WeightType));
+        it += (n + 1) * sizeof(WeightType);
+        prefix_values_.resize(n + 1);
+        std::memcpy(prefix_values_.data(), it, (n + 1) * sizeof(ValueType));
+    }
+
    public:
     KnapsackInstance() = default;
-    KnapsackInstance(std::filesystem::path const& file) {
-        std::ifstream in{file};
-        if (!in) {
+
+    // Items in any order, they are sorted with `num_threads` threads
+    KnapsackInstance(std::vector<Item> items, WeightType capacity, unsigned int num_threads = 1) : capacity_{capacity} {
+        build(std::move(items), num_threads);
+    }
+
+    // Reads the text format (number of items, capacity, then value and weight of each item, as written by the
+    // generator and used by kplib) or the binary format written by write_binary(). Large text instances are sorted
+    // with `num_threads` threads.
+    KnapsackInstance(std::filesystem::path const& file, unsigned int num_threads = 1) {
+        int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd == -1) {
             throw std::runtime_error{"Could not open file"};
         }
-        std::size_t n{};
-        in >> n;
-        if (!in || in.eof()) {
+        struct stat sb {};
+        if (::fstat(fd, &sb) == -1) {
+            ::close(fd);
+            throw std::runtime_error{"Could not get file size"};
+        }
+        auto length = static_cast<std::size_t>(sb.st_size);
+        if (length == 0) {
+            ::close(fd);
             throw std::runtime_error{"Could not get number of items"};
         }
-        prefix_sum_.clear();
-        prefix_sum_.reserve(n + 1);
-        in >> capacity_;
-        if (!in || (n > 0 && in.eof())) {
-            throw std::runtime_error{"Could not get capacity"};
+        auto* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error{"mmap failed"};
         }
-
-        for (std::size_t i = 0; i < n; ++i) {
-            if (!in || in.eof()) {
-                throw std::runtime_error{"Unexpected end of file"};
-            }
-            auto item = Item{};
-            in >> item.value;
-            if (!in || in.eof()) {
-                throw std::runtime_error{"Could not read item value"};
+        ::madvise(addr, length, MADV_SEQUENTIAL);
+        auto const* begin = static_cast<char const*>(addr);
+        try {
+            if (length >= sizeof(binary_magic) && std::memcmp(begin, binary_magic, sizeof(binary_magic)) == 0) {
+                read_binary(begin, begin + length);
+            } else {
+                read_text(begin, begin + length, num_threads);
             }
-            in >> item.weight;
-            if (!in) {
-                throw std::runtime_error{"Could not read item weight"};
-            }
-            prefix_sum_.push_back(item);
+        } catch (std::runtime_error const&) {
+            ::munmap(addr, length);
+            throw;
+        }
+        ::munmap(addr, length);
+    }
+
+    // Writes the sorted prefix sums, so that loading the instance needs neither parsing nor sorting
+    void write_binary(std::filesystem::path const& file) const {
+        std::ofstream out{file, std::ios::binary};
+        if (!out) {
+            throw std::runtime_error{"Could not open file"};
+        }
+        BinaryHeader header{};
+        std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+        header.num_items = size();
+        header.weight_type = type_tag<WeightType>();
+        header.value_type = type_tag<ValueType>();
+        out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        out.write(reinterpret_cast<char const*>(&capacity_), sizeof(capacity_));
+        out.write(reinterpret_cast<char const*>(prefix_weights_.data()),
+                  static_cast<std::streamsize>(prefix_weights_.size() * sizeof(WeightType)));
+        out.write(reinterpret_cast<char const*>(prefix_values_.data()),
+                  static_cast<std::streamsize>(prefix_values_.size() * sizeof(ValueType)));
+        if (!out) {
+            throw std::runtime_error{"Write failed"};
         }
-        std::sort(prefix_sum_.begin(), prefix_sum_.end(), [](auto const& lhs, auto const& rhs) {
-            return (static_cast<double>(lhs.value) / static_cast<double>(lhs.weight)) >
-                (static_cast<double>(rhs.value) / static_cast<double>(rhs.weight));
-        });
-        std::inclusive_scan(prefix_sum_.begin(), prefix_sum_.end(), prefix_sum_.begin(),
-                            [](auto const& lhs, auto const& rhs) {
-                                return Item{lhs.weight + rhs.weight, lhs.value + rhs.value};
-                            });
-        prefix_sum_.insert(prefix_sum_.begin(), Item{0, 0});
     }
 
     [[nodiscard]] std::size_t size() const noexcept {
-        return prefix_sum_.size() - 1;
+        return prefix_weights_.size() - 1;
     }
 
     [[nodiscard]] WeightType capacity() const noexcept {
@@ -77,43 +273,335 @@ class KnapsackInstance {
     }
 
     [[nodiscard]] WeightType weight(std::size_t index) const noexcept {
-        return prefix_sum_[index + 1].weight - prefix_sum_[index].weight;
+        return prefix_weights_[index + 1] - prefix_weights_[index];
     }
 
     [[nodiscard]] ValueType value(std::size_t index) const noexcept {
-        return prefix_sum_[index + 1].value - prefix_sum_[index].value;
+        return prefix_values_[index + 1] - prefix_values_[index];
     }
 
-    [[nodiscard]] std::pair<ValueType, ValueType> compute_bounds_linear(WeightType capacity,
-                                                                        std::size_t index) const noexcept {
-        assert(index < prefix_sum_.size());
-        auto value_offset = prefix_sum_[index].value;
-        capacity += prefix_sum_[index].weight;
-        while (index < size() && capacity >= prefix_sum_[index + 1].weight) {
+    // The critical item for the items from `index` on is at the largest position k >= index with the items in
+    // [index, k) fitting into `capacity`. All searches return the same position.
+    [[nodiscard]] std::size_t critical_item_linear(WeightType capacity, std::size_t index) const noexcept {
+        assert(index < prefix_weights_.size());
+        auto limit = prefix_weights_[index] + capacity;
+        while (index < size() && prefix_weights_[index + 1] <= limit) {
             ++index;
         }
-        auto lower_bound = prefix_sum_[index].value - value_offset;
-        if (index == size() || capacity == prefix_sum_[index].weight) {
-            return {lower_bound, lower_bound};
+        return index;
+    }
+
+    [[nodiscard]] std::size_t critical_item_binary(WeightType capacity, std::size_t index) const noexcept {
+        assert(index < prefix_weights_.size());
+        auto it = std::upper_bound(std::next(prefix_weights_.begin(), static_cast<std::ptrdiff_t>(index) + 1),
+                                   prefix_weights_.end(), prefix_weights_[index] + capacity);
+        return static_cast<std::size_t>(std::distance(prefix_weights_.begin(), it)) - 1;
+    }
+
+    // Exponential search around `hint`, typically the critical item of the parent node. Takes time logarithmic in the
+    // distance between the hint and the critical item.
+    [[nodiscard]] std::size_t critical_item_galloping(WeightType capacity, std::size_t index,
+                                                      std::size_t hint) const noexcept {
+        assert(index < prefix_weights_.size());
+        auto limit = prefix_weights_[index] + capacity;
+        hint = std::clamp(hint, index, size());
+        // Invariant: prefix_weights_[low] <= limit and prefix_weights_[high] > limit if high <= size()
+        std::size_t low = hint;
+        std::size_t high = hint;
+        if (prefix_weights_[hint] <= limit) {
+            std::size_t step = 1;
+            high = low + 1;
+            while (high <= size() && prefix_weights_[high] <= limit) {
+                low = high;
+                step *= 2;
+                high = low + step;
+            }
+            high = std::min(high, size() + 1);
+        } else {
+            std::size_t step = 1;
+            while (true) {
+                low = high - index > step ? high - step : index;
+                if (prefix_weights_[low] <= limit) {
+                    break;
+                }
+                high = low;
+                step *= 2;
+            }
+        }
+        auto it = std::upper_bound(std::next(prefix_weights_.begin(), static_cast<std::ptrdiff_t>(low) + 1),
+                                   std::next(prefix_weights_.begin(), static_cast<std::ptrdiff_t>(high)), limit);
+        return static_cast<std::size_t>(std::distance(prefix_weights_.begin(), it)) - 1;
+    }
+
+    // Linear scan comparing a vector of prefix weights at a time, falls back to the scalar scan if the weight type or
+    // the target has no vector support
+    [[nodiscard]] std::size_t critical_item_simd(WeightType capacity, std::size_t index) const noexcept {
+        assert(index < prefix_weights_.size());
+        auto limit = prefix_weights_[index] + capacity;
+        auto i = index + 1;
+#if defined __AVX512F__
+        if constexpr (std::is_same_v<WeightType, long long> || std::is_same_v<WeightType, double>) {
+            constexpr std::size_t lanes = 8;
+            for (; i + lanes <= prefix_weights_.size(); i += lanes) {
+                unsigned mask = 0;
+                if constexpr (std::is_same_v<WeightType, long long>) {
+                    mask = _mm512_cmpgt_epi64_mask(_mm512_loadu_si512(prefix_weights_.data() + i),
+                                                   _mm512_set1_epi64(limit));
+                } else {
+                    mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(prefix_weights_.data() + i), _mm512_set1_pd(limit),
+                                              _CMP_GT_OQ);
+                }
+                if (mask != 0) {
+                    return i + static_cast<std::size_t>(__builtin_ctz(mask)) - 1;
+                }
+            }
+        }
+#elif defined __AVX2__
+        if constexpr (std::is_same_v<WeightType, long long> || std::is_same_v<WeightType, double>) {
+            constexpr std::size_t lanes = 4;
+            for (; i + lanes <= prefix_weights_.size(); i += lanes) {
+                int mask = 0;
+                if constexpr (std::is_same_v<WeightType, long long>) {
+                    auto weights = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(prefix_weights_.data() + i));
+                    mask = _mm256_movemask_pd(
+                        _mm256_castsi256_pd(_mm256_cmpgt_epi64(weights, _mm256_set1_epi64x(limit))));
+                } else {
+                    mask = _mm256_movemask_pd(
+                        _mm256_cmp_pd(_mm256_loadu_pd(prefix_weights_.data() + i), _mm256_set1_pd(limit), _CMP_GT_OQ));
+                }
+                if (mask != 0) {
+                    return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask))) - 1;
+                }
+            }
+        }
+#endif
+        while (i < prefix_weights_.size() && prefix_weights_[i] <= limit) {
+            ++i;
+        }
+        return i - 1;
+    }
+
+    // Value of `weight` at the efficiency of item `index`, rounded such that bounds built from it stay valid for
+    // integral values
+    [[nodiscard]] ValueType value_at_efficiency_floor(WeightType w, std::size_t index) const noexcept {
+        auto product = value(index) * w;
+        if constexpr (std::is_integral_v<ValueType> && std::is_integral_v<WeightType>) {
+            auto quotient = product / weight(index);
+            return quotient * weight(index) > product ? quotient - 1 : quotient;
+        } else {
+            return product / weight(index);
+        }
+    }
+
+    [[nodiscard]] ValueType value_at_efficiency_ceil(WeightType w, std::size_t index) const noexcept {
+        auto product = value(index) * w;
+        if constexpr (std::is_integral_v<ValueType> && std::is_integral_v<WeightType>) {
+            auto quotient = product / weight(index);
+            return quotient * weight(index) < product ? quotient + 1 : quotient;
+        } else {
+            return product / weight(index);
+        }
+    }
+
+    // U2 of Martello and Toth: either the critical item is left out and the next item fills the residual capacity
+    // fractionally, or it is packed and the fraction of the item before it that makes room is taken out
+    [[nodiscard]] ValueType martello_toth_bound(std::size_t index, std::size_t critical, ValueType lower_bound,
+                                                WeightType residual_capacity) const noexcept {
+        auto bound = lower_bound;
+        if (critical + 1 < size() && weight(critical + 1) > WeightType{}) {
+            bound += value_at_efficiency_floor(residual_capacity, critical + 1);
+        }
+        // Without items of positive weight before it, the critical item does not fit. Items without weight sort
+        // first, so if the item before it has none, neither has any earlier item.
+        if (critical > index && weight(critical - 1) > WeightType{}) {
+            auto overflow = weight(critical) - residual_capacity;
+            bound = std::max(bound, lower_bound + value(critical) - value_at_efficiency_ceil(overflow, critical - 1));
+        }
+        return bound;
+    }
+
+    // Müller-Merbach: every solution other than the greedy one drops an item before the critical item or packs one
+    // after it, and the capacity this frees or takes is valued at the efficiency of the critical item
+    [[nodiscard]] ValueType mueller_merbach_bound(WeightType capacity, std::size_t index, std::size_t critical,
+                                                  ValueType lower_bound,
+                                                  WeightType residual_capacity) const noexcept {
+        auto bound = lower_bound;
+        for (auto j = index; j < critical; ++j) {
+            auto freed = residual_capacity + weight(j);
+            bound = std::max(bound, lower_bound - value(j) + value_at_efficiency_floor(freed, critical));
+        }
+        for (auto j = critical + 1; j < size(); ++j) {
+            if (weight(j) <= capacity) {
+                bound = std::max(bound, lower_bound + value(j) -
+                                     value_at_efficiency_ceil(weight(j) - residual_capacity, critical));
+            }
         }
-        auto residual_capacity = capacity - prefix_sum_[index].weight;
-        auto fractional_value = (value(index) * residual_capacity) / weight(index);
-        return {lower_bound, lower_bound + fractional_value};
+        return bound;
+    }
+
+    // The lower bound takes the items before the critical item. Dantzig's upper bound adds the fitting fraction of
+    // the critical item, the other policies only tighten it.
+    template <BoundPolicy Bound = BoundPolicy::dantzig>
+    [[nodiscard]] Bounds bounds_at(WeightType capacity, std::size_t index, std::size_t critical) const noexcept {
+        assert(critical >= index && critical <= size());
+        ValueType lower_bound = prefix_values_[critical] - prefix_values_[index];
+        auto residual_capacity = capacity - (prefix_weights_[critical] - prefix_weights_[index]);
+        if (critical == size() || residual_capacity == WeightType{}) {
+            return {lower_bound, lower_bound, critical};
+        }
+        auto fractional_value = (value(critical) * residual_capacity) / weight(critical);
+        Bounds bounds{lower_bound, lower_bound + fractional_value, critical};
+        if constexpr (Bound != BoundPolicy::dantzig) {
+            bounds.upper =
+                std::min(bounds.upper, martello_toth_bound(index, critical, lower_bound, residual_capacity));
+        }
+        if constexpr (Bound == BoundPolicy::mueller_merbach) {
+            bounds.upper = std::min(bounds.upper,
+                                    mueller_merbach_bound(capacity, index, critical, lower_bound, residual_capacity));
+        }
+        return bounds;
+    }
+
+    // `hint` is only used by the galloping search
+    template <CriticalSearch Search, BoundPolicy Bound = BoundPolicy::dantzig>
+    [[nodiscard]] Bounds compute_bounds(WeightType capacity, std::size_t index, std::size_t hint = 0) const noexcept {
+        if constexpr (Search == CriticalSearch::linear) {
+            return bounds_at<Bound>(capacity, index, critical_item_linear(capacity, index));
+        } else if constexpr (Search == CriticalSearch::binary) {
+            return bounds_at<Bound>(capacity, index, critical_item_binary(capacity, index));
+        } else if constexpr (Search == CriticalSearch::galloping) {
+            return bounds_at<Bound>(capacity, index, critical_item_galloping(capacity, index, hint));
+        } else {
+            return bounds_at<Bound>(capacity, index, critical_item_simd(capacity, index));
+        }
+    }
+
+    [[nodiscard]] std::pair<ValueType, ValueType> compute_bounds_linear(WeightType capacity,
+                                                                        std::size_t index) const noexcept {
+        auto bounds = compute_bounds<CriticalSearch::linear>(capacity, index);
+        return {bounds.lower, bounds.upper};
     }
 
     [[nodiscard]] std::pair<ValueType, ValueType> compute_bounds_binary(WeightType capacity,
                                                                         std::size_t index) const noexcept {
-        assert(index < prefix_sum_.size());
-        auto it = std::upper_bound(std::next(prefix_sum_.begin(), static_cast<std::ptrdiff_t>(index) + 1),
-                                   prefix_sum_.end(), prefix_sum_[index].weight + capacity,
-                                   [](auto lhs, auto const& rhs) { return lhs < rhs.weight; });
-        ValueType lower_bound = std::prev(it)->value - prefix_sum_[index].value;
-        if (it == prefix_sum_.end()) {
-            return {lower_bound, lower_bound};
-        }
-        auto residual_capacity = capacity - (std::prev(it)->weight - prefix_sum_[index].weight);
-        auto fractional_value =
-            ((it->value - std::prev(it)->value) * residual_capacity) / (it->weight - std::prev(it)->weight);
-        return {lower_bound, lower_bound + fractional_value};
+        auto bounds = compute_bounds<CriticalSearch::binary>(capacity, index);
+        return {bounds.lower, bounds.upper};
+    }
+
+    // Optimal value of the items from `index` on with `capacity`, by dynamic programming over the capacities in
+    // O(capacity * (size() - index)) time. Each item only updates the capacities reachable with it and the items
+    // before it, so light items keep the inner loop short. `table` is scratch space reused between subproblems.
+    [[nodiscard]] ValueType solve_suffix(WeightType capacity, std::size_t index,
+                                         std::vector<ValueType>& table) const {
+        static_assert(std::is_integral_v<WeightType>, "Dynamic programming needs integral weights");
+        assert(index <= size() && capacity >= WeightType{});
+        if (prefix_weights_[size()] - prefix_weights_[index] <= capacity) {
+            return prefix_values_[size()] - prefix_values_[index];
+        }
+        auto const cells = static_cast<std::size_t>(capacity) + 1;
+        table.assign(cells, ValueType{});
+        std::size_t reachable = 0;
+        for (auto i = index; i < size(); ++i) {
+            auto w = static_cast<std::size_t>(weight(i));
+            if (w >= cells) {
+                continue;
+            }
+            auto v = value(i);
+            auto extended = std::min(reachable + w, cells - 1);
+            std::fill(table.begin() + static_cast<std::ptrdiff_t>(reachable) + 1,
+                      table.begin() + static_cast<std::ptrdiff_t>(extended) + 1, table[reachable]);
+            reachable = extended;
+            for (auto c = reachable + 1; c-- > w;) {
+                table[c] = std::max(table[c], table[c - w] + v);
+            }
+        }
+        // table[c] is the best value with weight at most c, larger capacities cannot do better than `reachable`
+        return table[reachable];
+    }
+
+    // Greedy solution that packs the items before the critical item and then every later item that still fits
+    [[nodiscard]] ValueType greedy_lower_bound() const noexcept {
+        auto critical = critical_item_binary(capacity_, 0);
+        auto residual_capacity = capacity_ - prefix_weights_[critical];
+        auto lower_bound = prefix_values_[critical];
+        for (auto i = critical; i < size(); ++i) {
+            if (weight(i) <= residual_capacity) {
+                residual_capacity -= weight(i);
+                lower_bound += value(i);
+            }
+        }
+        return lower_bound;
     }
+
+    // Dantzig bound of all solutions that pack item `index` differently than the greedy solution, i.e. without it if
+    // it is before the critical item and with it otherwise
+    [[nodiscard]] ValueType flipped_upper_bound(std::size_t index, std::size_t critical) const noexcept {
+        if (index < critical) {
+            return prefix_values_[index] +
+                compute_bounds<CriticalSearch::binary>(capacity_ - prefix_weights_[index], index + 1).upper;
+        }
+        auto capacity = capacity_ - weight(index);
+        auto remaining = critical_item_binary(capacity, 0);
+        if (remaining < index) {
+            return value(index) + bounds_at(capacity, 0, remaining).upper;
+        }
+        return value(index) + prefix_values_[index] +
+            compute_bounds<CriticalSearch::binary>(capacity - prefix_weights_[index], index + 1).upper;
+    }
+
+    // Fixes every item whose flipped upper bound is not better than the greedy lower bound to its greedy decision,
+    // since no better solution can pack it differently. The remaining items form the reduced instance, typically a
+    // core around the critical item. The bound tests are independent and split among `num_threads` threads.
+    [[nodiscard]] Reduction reduce(unsigned int num_threads = 1) const {
+        Reduction reduction;
+        reduction.lower_bound = greedy_lower_bound();
+        auto critical = critical_item_binary(capacity_, 0);
+        std::vector<char> fixed(size(), 0);
+        auto test = [&](std::size_t begin, std::size_t end) noexcept {
+            for (auto i = begin; i < end; ++i) {
+                fixed[i] = static_cast<char>((i >= critical && weight(i) > capacity_) ||
+                                             flipped_upper_bound(i, critical) <= reduction.lower_bound);
+            }
+        };
+        num_threads = std::max(1U, std::min(num_threads, static_cast<unsigned int>(size() / 1024 + 1)));
+        std::vector<std::thread> workers;
+        auto block_size = (size() + num_threads - 1) / num_threads;
+        for (unsigned int t = 1; t < num_threads; ++t) {
+            workers.emplace_back(test, std::min(t * block_size, size()), std::min((t + 1) * block_size, size()));
+        }
+        test(0, std::min(block_size, size()));
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        auto& reduced = reduction.instance;
+        reduced.capacity_ = capacity_;
+        reduced.prefix_weights_.assign(1, WeightType{});
+        reduced.prefix_values_.assign(1, ValueType{});
+        // Removing items keeps the order by efficiency
+        for (std::size_t i = 0; i < size(); ++i) {
+            if (fixed[i] == 0) {
+                reduced.prefix_weights_.push_back(reduced.prefix_weights_.back() + weight(i));
+                reduced.prefix_values_.push_back(reduced.prefix_values_.back() + value(i));
+            } else if (i < critical) {
+                reduced.capacity_ -= weight(i);
+                reduction.offset += value(i);
+                ++reduction.fixed_taken;
+            } else {
+                ++reduction.fixed_skipped;
+            }
+        }
+        return reduction;
+    }
+};
+
+// The optimal value of the original instance is the larger of `lower_bound` and `offset` plus the optimal value of
+// the reduced instance
+template <typename WeightType, typename ValueType>
+struct KnapsackInstance<WeightType, ValueType>::Reduction {
+    KnapsackInstance instance;
+    ValueType offset{};
+    ValueType lower_bound{};
+    std::size_t fixed_taken = 0;
+    std::size_t fixed_skipped = 0;
 };
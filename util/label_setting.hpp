@@ -0,0 +1,223 @@
+#pragma once
+
+#include "affinity.hpp"
+#include "graph.hpp"
+#include "task.hpp"
+#include "termination_detection.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Parallel label-setting search over a relaxed priority queue, parameterized by a path algebra (see
+// path_algebra.hpp). Nodes are pushed again whenever their label improves, and stale entries are ignored on pop.
+// The storage of the labels and the hooks into the search loop are template parameters, so that applications can
+// add their own per-node state and search modes without copying the loop.
+namespace label_setting {
+
+struct ThreadStats {
+    std::pair<std::chrono::steady_clock::time_point, std::chrono::steady_clock::time_point> work_time;
+    long long pushed_nodes{0};
+    long long ignored_nodes{0};
+    long long processed_nodes{0};
+    long long relaxed_edges{0};
+};
+
+inline ThreadStats accumulate(ThreadStats accum, ThreadStats const& e) noexcept {
+    accum.work_time.first = std::min(accum.work_time.first, e.work_time.first);
+    accum.work_time.second = std::max(accum.work_time.second, e.work_time.second);
+    accum.pushed_nodes += e.pushed_nodes;
+    accum.processed_nodes += e.processed_nodes;
+    accum.ignored_nodes += e.ignored_nodes;
+    accum.relaxed_edges += e.relaxed_edges;
+    return accum;
+}
+
+// One label per node, each in its own cache line
+template <typename Algebra>
+class PaddedLabels {
+   public:
+    using label_type = typename Algebra::label_type;
+
+   private:
+    struct alignas(L1_CACHE_LINESIZE) Entry {
+        std::atomic<label_type> value{Algebra::unreached()};
+    };
+
+    std::vector<Entry> entries_;
+
+   public:
+    explicit PaddedLabels(std::size_t num_nodes) : entries_(num_nodes) {
+    }
+
+    std::atomic<label_type>& operator[](std::size_t i) noexcept {
+        return entries_[i].value;
+    }
+
+    std::atomic<label_type> const& operator[](std::size_t i) const noexcept {
+        return entries_[i].value;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return entries_.size();
+    }
+};
+
+template <typename Algebra, typename GraphType = Graph, typename Labels = PaddedLabels<Algebra>>
+struct SharedData {
+    using label_type = typename Algebra::label_type;
+
+    GraphType const& graph;
+    Labels labels;
+    termination_detection::Data termination_detection_data{};
+
+    explicit SharedData(GraphType const& g) : graph{g}, labels(g.num_nodes()) {
+    }
+
+    // Sequentially consistent (no extra cost on x86), so that hooks keeping per-node state can order it after the
+    // label update
+    bool update_label(std::size_t index, label_type current, label_type target) noexcept {
+        while (Algebra::better(target, current)) {
+            if (labels[index].compare_exchange_weak(current, target)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Hooks of the plain search, which pushes nodes with their label as key and processes all their edges.
+// Applications replace them to change how entries are popped, recognized as stale, expanded and pushed.
+template <typename Algebra>
+struct PlainHooks {
+    using label_type = typename Algebra::label_type;
+
+    template <typename Handle>
+    auto pop(Handle& handle) {
+        return handle.try_pop();
+    }
+
+    // The node whose label an entry refers to
+    template <typename Entry>
+    static std::size_t node(Entry const& entry) noexcept {
+        return static_cast<std::size_t>(entry.second);
+    }
+
+    // Called for every popped entry before its label is read
+    template <typename Entry>
+    static void popped(Entry const& /*entry*/) noexcept {
+    }
+
+    template <typename Entry>
+    static bool stale(Entry const& entry, label_type label) noexcept {
+        return Algebra::better(label, Algebra::from_key(entry.first));
+    }
+
+    // Calls `relax(target, new_label)` for the edges to expand from the entry
+    template <typename GraphType, typename Handle, typename Entry, typename Relax>
+    static void relax_edges(GraphType const& graph, Handle& /*handle*/, Entry const& entry, label_type label,
+                            ThreadStats& stats, Relax&& relax) {
+        graph.for_each_edge(node(entry), [&](std::size_t target, Graph::weight_type weight) {
+            ++stats.relaxed_edges;
+            relax(target, Algebra::combine(label, weight));
+        });
+    }
+
+    // Called after the label of `target` improved from an entry with `label` to `new_label`
+    template <typename Handle>
+    static void push(Handle& handle, std::size_t target, label_type /*label*/, label_type new_label,
+                     ThreadStats& stats) {
+        handle.push({Algebra::to_key(new_label), target});
+        ++stats.pushed_nodes;
+    }
+};
+
+template <typename Algebra, typename GraphType, typename Labels, typename Handle, typename Hooks>
+bool process_node(Handle& handle, Hooks& hooks, ThreadStats& stats, SharedData<Algebra, GraphType, Labels>& data) {
+    auto entry = hooks.pop(handle);
+    if (!entry) {
+        return false;
+    }
+    auto node = hooks.node(*entry);
+    hooks.popped(*entry);
+    auto label = data.labels[node].load();
+    if (hooks.stale(*entry, label)) {
+        ++stats.ignored_nodes;
+        return true;
+    }
+    ++stats.processed_nodes;
+    hooks.relax_edges(data.graph, handle, *entry, label, stats,
+                      [&](std::size_t target, typename Algebra::label_type new_label) {
+                          if (data.update_label(target, data.labels[target].load(std::memory_order_relaxed),
+                                                new_label)) {
+                              hooks.push(handle, target, label, new_label, stats);
+                          }
+                      });
+    return true;
+}
+
+// Thread 0 pushes `entries`, whose labels must already be set. Then all threads process entries until the queue is
+// empty.
+template <typename Algebra, typename GraphType, typename Labels, typename PQ, typename Hooks, typename Entries>
+ThreadStats run_thread(task::Control tc, PQ& pq, SharedData<Algebra, GraphType, Labels>& data, Hooks& hooks,
+                       Entries const& entries) {
+    ThreadStats stats;
+    typename PQ::handle_type handle = pq.get_handle();
+    if (tc.id() == 0) {
+        for (auto const& entry : entries) {
+            handle.push(entry);
+            ++stats.pushed_nodes;
+        }
+    }
+    tc.synchronize();
+    auto start_time = std::chrono::steady_clock::now();
+    while (termination_detection::try_do(tc.num_threads(), data.termination_detection_data,
+                                         [&]() { return process_node(handle, hooks, stats, data); })) {
+    }
+    auto end_time = std::chrono::steady_clock::now();
+    tc.synchronize();
+    stats.work_time = {start_time, end_time};
+    return stats;
+}
+
+// Plain search from node 0
+template <typename Algebra, typename GraphType, typename Labels, typename PQ>
+ThreadStats run_thread(task::Control tc, PQ& pq, SharedData<Algebra, GraphType, Labels>& data) {
+    if (tc.id() == 0) {
+        data.labels[0] = Algebra::source();
+    }
+    PlainHooks<Algebra> hooks;
+    std::pair<unsigned long, std::size_t> const entries[] = {{Algebra::to_key(Algebra::source()), 0}};
+    return run_thread(tc, pq, data, hooks, entries);
+}
+
+// Checks in parallel that no edge can improve the label of its target
+template <typename Algebra, typename GraphType, typename Labels, typename Affinity>
+bool verify(SharedData<Algebra, GraphType, Labels> const& data, Affinity affinity, int num_threads) {
+    std::atomic_bool valid{true};
+    task::Runner runner{affinity, num_threads, [&](auto tc) noexcept {
+                            auto num_nodes = data.labels.size();
+                            auto id = static_cast<std::size_t>(tc.id());
+                            auto p = static_cast<std::size_t>(tc.num_threads());
+                            for (std::size_t i = num_nodes * id / p;
+                                 i < num_nodes * (id + 1) / p && valid.load(std::memory_order_relaxed); ++i) {
+                                auto label = data.labels[i].load(std::memory_order_relaxed);
+                                if (label == Algebra::unreached()) {
+                                    continue;
+                                }
+                                data.graph.for_each_edge(i, [&](std::size_t target, Graph::weight_type weight) {
+                                    if (Algebra::better(Algebra::combine(label, weight),
+                                                        data.labels[target].load(std::memory_order_relaxed))) {
+                                        valid.store(false, std::memory_order_relaxed);
+                                    }
+                                });
+                            }
+                        }};
+    runner.wait();
+    return valid.load();
+}
+
+}  // namespace label_setting
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size node storage for applications that only want to move small handles through the priority queue. Each
+// thread owns an arena that grows in chunks, which are allocated and first touched by the owning thread so that they
+// are placed on its NUMA node. A handle stores the arena id in the upper 16 bits and the slot index in the lower
+// bits. Chunks never move, so other threads can read nodes concurrently as long as the handle was passed through a
+// synchronizing operation (e.g. the priority queue).
+//
+// Freed slots are recycled in one of two ways: by default, the freeing thread keeps the slot on its own free list
+// regardless of which arena it belongs to, which needs no synchronization. With `return_home`, slots of other arenas
+// are returned to their owner via a lock-free stack, so every thread only ever writes to node-local memory.
+template <typename T>
+class NodePool {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_default_constructible_v<T>,
+                  "Nodes are stored in a union with the free list link");
+
+   public:
+    using handle_type = std::uint64_t;
+    static constexpr unsigned int arena_shift = 48;
+    static constexpr unsigned int chunk_bits = 16;
+    static constexpr std::size_t chunk_size = std::size_t{1} << chunk_bits;
+    static constexpr std::size_t max_chunks = std::size_t{1} << 14;
+    static constexpr handle_type invalid_handle = std::numeric_limits<handle_type>::max();
+
+   private:
+    union Slot {
+        T node;
+        handle_type next;
+    };
+
+    struct alignas(L1_CACHE_LINESIZE) Arena {
+        std::unique_ptr<std::unique_ptr<Slot[]>[]> chunks;
+        std::size_t num_slots = 0;
+        std::vector<handle_type> free_list;
+        alignas(L1_CACHE_LINESIZE) std::atomic<handle_type> remote_free{invalid_handle};
+    };
+
+    std::unique_ptr<Arena[]> arenas_;
+    std::size_t num_arenas_;
+    bool return_home_;
+
+    Slot& slot(handle_type handle) const noexcept {
+        auto index = handle & ((handle_type{1} << arena_shift) - 1);
+        assert((handle >> arena_shift) < num_arenas_);
+        auto& arena = arenas_[handle >> arena_shift];
+        return arena.chunks[index >> chunk_bits][index & (chunk_size - 1)];
+    }
+
+    void collect_remote(Arena& arena) {
+        auto handle = arena.remote_free.exchange(invalid_handle, std::memory_order_acquire);
+        while (handle != invalid_handle) {
+            arena.free_list.push_back(handle);
+            handle = slot(handle).next;
+        }
+    }
+
+   public:
+    NodePool(int num_arenas, bool return_home)
+        : arenas_{new Arena[static_cast<std::size_t>(num_arenas)]},
+          num_arenas_{static_cast<std::size_t>(num_arenas)},
+          return_home_{return_home} {
+        if (num_arenas <= 0 || num_arenas_ > (std::size_t{1} << (64 - arena_shift))) {
+            throw std::runtime_error{"Invalid number of node arenas"};
+        }
+        for (std::size_t i = 0; i < num_arenas_; ++i) {
+            arenas_[i].chunks.reset(new std::unique_ptr<Slot[]>[max_chunks]);
+        }
+    }
+
+    // Must only be called by the thread owning arena `id`
+    handle_type allocate(int id, T const& node) {
+        auto& arena = arenas_[static_cast<std::size_t>(id)];
+        if (arena.free_list.empty() && return_home_) {
+            collect_remote(arena);
+        }
+        handle_type handle;
+        if (!arena.free_list.empty()) {
+            handle = arena.free_list.back();
+            arena.free_list.pop_back();
+        } else {
+            if (arena.num_slots % chunk_size == 0) {
+                auto chunk = arena.num_slots >> chunk_bits;
+                if (chunk == max_chunks) {
+                    throw std::runtime_error{"Node arena is full"};
+                }
+                // Default initialization leaves the memory untouched until the owner writes it
+                arena.chunks[chunk].reset(new Slot[chunk_size]);
+            }
+            handle = (static_cast<handle_type>(id) << arena_shift) | arena.num_slots;
+            ++arena.num_slots;
+        }
+        slot(handle).node = node;
+        return handle;
+    }
+
+    // Must only be called by the thread owning arena `id`
+    void free(int id, handle_type handle) {
+        auto owner = handle >> arena_shift;
+        if (return_home_ && owner != static_cast<handle_type>(id)) {
+            auto& home = arenas_[owner];
+            auto& link = slot(handle).next;
+            link = home.remote_free.load(std::memory_order_relaxed);
+            while (!home.remote_free.compare_exchange_weak(link, handle, std::memory_order_release,
+                                                           std::memory_order_relaxed)) {
+            }
+            return;
+        }
+        arenas_[static_cast<std::size_t>(id)].free_list.push_back(handle);
+    }
+
+    T const& operator[](handle_type handle) const noexcept {
+        return slot(handle).node;
+    }
+
+    [[nodiscard]] bool return_home() const noexcept {
+        return return_home_;
+    }
+
+    // Only meaningful after all threads are done
+    [[nodiscard]] std::size_t allocated_slots() const noexcept {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < num_arenas_; ++i) {
+            total += arenas_[i].num_slots;
+        }
+        return total;
+    }
+
+    [[nodiscard]] static constexpr std::size_t slot_size() noexcept {
+        return sizeof(Slot);
+    }
+};
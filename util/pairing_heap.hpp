@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Min pairing heap over the indices [0, n) with decrease-key. Every index can be in the heap at most once.
+template <typename Key>
+class IndexedPairingHeap {
+    static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+    struct Entry {
+        Key key;
+        std::size_t child = none;
+        std::size_t sibling = none;
+        // Parent if this is the leftmost child, left sibling otherwise
+        std::size_t prev = none;
+        bool in_heap = false;
+    };
+
+    std::vector<Entry> entries_;
+    std::vector<std::size_t> roots_;
+    std::size_t root_{none};
+    std::size_t size_{0};
+
+    std::size_t meld(std::size_t a, std::size_t b) noexcept {
+        if (a == none) {
+            return b;
+        }
+        if (b == none) {
+            return a;
+        }
+        if (entries_[b].key < entries_[a].key) {
+            std::swap(a, b);
+        }
+        entries_[b].sibling = entries_[a].child;
+        if (entries_[a].child != none) {
+            entries_[entries_[a].child].prev = b;
+        }
+        entries_[b].prev = a;
+        entries_[a].child = b;
+        return a;
+    }
+
+    void cut(std::size_t index) noexcept {
+        auto& e = entries_[index];
+        if (entries_[e.prev].child == index) {
+            entries_[e.prev].child = e.sibling;
+        } else {
+            entries_[e.prev].sibling = e.sibling;
+        }
+        if (e.sibling != none) {
+            entries_[e.sibling].prev = e.prev;
+        }
+        e.sibling = none;
+        e.prev = none;
+    }
+
+    // Two-pass pairing of the children of the removed root
+    std::size_t combine_children(std::size_t first) {
+        roots_.clear();
+        while (first != none) {
+            auto a = first;
+            auto b = entries_[a].sibling;
+            first = b == none ? none : entries_[b].sibling;
+            entries_[a].sibling = entries_[a].prev = none;
+            if (b != none) {
+                entries_[b].sibling = entries_[b].prev = none;
+            }
+            roots_.push_back(meld(a, b));
+        }
+        std::size_t root = none;
+        while (!roots_.empty()) {
+            root = meld(roots_.back(), root);
+            roots_.pop_back();
+        }
+        return root;
+    }
+
+   public:
+    explicit IndexedPairingHeap(std::size_t n) : entries_(n) {
+    }
+
+    void push(std::size_t index, Key key) {
+        assert(!entries_[index].in_heap);
+        entries_[index] = Entry{key, none, none, none, true};
+        root_ = meld(root_, index);
+        ++size_;
+    }
+
+    void decrease_key(std::size_t index, Key key) noexcept {
+        assert(entries_[index].in_heap && !(entries_[index].key < key));
+        entries_[index].key = key;
+        if (index != root_) {
+            cut(index);
+            root_ = meld(root_, index);
+        }
+    }
+
+    [[nodiscard]] std::pair<Key, std::size_t> top() const noexcept {
+        assert(root_ != none);
+        return {entries_[root_].key, root_};
+    }
+
+    void pop() {
+        assert(root_ != none);
+        entries_[root_].in_heap = false;
+        root_ = combine_children(entries_[root_].child);
+        --size_;
+    }
+
+    [[nodiscard]] bool contains(std::size_t index) const noexcept {
+        return entries_[index].in_heap;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_;
+    }
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "graph.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// Path algebras for label-setting searches. An algebra defines the label of the source (the identity of `combine`),
+// the label of unreached nodes, how a label is extended over an edge and which of two labels is better. `combine` must
+// never produce a label better than its input, so that labels popped in priority order are final.
+// Labels are mapped to unsigned long keys such that better labels are popped first from a min-queue if `min_queue` is
+// true and from a max-queue otherwise.
+namespace path_algebra {
+
+struct ShortestPath {
+    using label_type = long long;
+    static constexpr bool min_queue = true;
+    static constexpr auto name = "shortest path";
+
+    static constexpr label_type source() noexcept {
+        return 0;
+    }
+
+    static constexpr label_type unreached() noexcept {
+        return std::numeric_limits<label_type>::max();
+    }
+
+    static constexpr label_type combine(label_type label, Graph::weight_type weight) noexcept {
+        return label + weight;
+    }
+
+    static constexpr bool better(label_type lhs, label_type rhs) noexcept {
+        return lhs < rhs;
+    }
+
+    static constexpr unsigned long to_key(label_type label) noexcept {
+        return static_cast<unsigned long>(label);
+    }
+
+    static constexpr label_type from_key(unsigned long key) noexcept {
+        return static_cast<label_type>(key);
+    }
+};
+
+// Maximizes the minimum edge weight (capacity) along the path
+struct WidestPath {
+    using label_type = long long;
+    static constexpr bool min_queue = false;
+    static constexpr auto name = "widest path";
+
+    static constexpr label_type source() noexcept {
+        return std::numeric_limits<label_type>::max();
+    }
+
+    static constexpr label_type unreached() noexcept {
+        return 0;
+    }
+
+    static constexpr label_type combine(label_type label, Graph::weight_type weight) noexcept {
+        return std::min(label, weight);
+    }
+
+    static constexpr bool better(label_type lhs, label_type rhs) noexcept {
+        return lhs > rhs;
+    }
+
+    static constexpr unsigned long to_key(label_type label) noexcept {
+        return static_cast<unsigned long>(label);
+    }
+
+    static constexpr label_type from_key(unsigned long key) noexcept {
+        return static_cast<label_type>(key);
+    }
+};
+
+// Maximizes the product of edge reliabilities along the path. An edge of weight w has reliability
+// 1 / (1 + w / weight_scale), so heavier edges are less reliable.
+struct MostReliablePath {
+    using label_type = double;
+    static constexpr bool min_queue = false;
+    static constexpr auto name = "most reliable path";
+    static constexpr double weight_scale = 1e6;
+
+    static constexpr label_type source() noexcept {
+        return 1.0;
+    }
+
+    static constexpr label_type unreached() noexcept {
+        return 0.0;
+    }
+
+    static constexpr label_type combine(label_type label, Graph::weight_type weight) noexcept {
+        return label / (1.0 + static_cast<double>(weight) / weight_scale);
+    }
+
+    static constexpr bool better(label_type lhs, label_type rhs) noexcept {
+        return lhs > rhs;
+    }
+
+    // The bit pattern of a nonnegative double is ordered like its value
+    static unsigned long to_key(label_type label) noexcept {
+        static_assert(sizeof(label_type) == sizeof(unsigned long));
+        unsigned long key;
+        std::memcpy(&key, &label, sizeof(key));
+        return key;
+    }
+
+    static label_type from_key(unsigned long key) noexcept {
+        label_type label;
+        std::memcpy(&label, &key, sizeof(label));
+        return label;
+    }
+};
+
+}  // namespace path_algebra
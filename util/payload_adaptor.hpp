@@ -0,0 +1,131 @@
+#pragma once
+
+#include "key_transform.hpp"
+#include "node_pool.hpp"
+#include "wrapper/util.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Runs applications with arbitrary keys and values on queues that only store (unsigned long, unsigned long) pairs.
+// Keys are mapped to integers of the same order (see key_transform.hpp). Values that fit into the second member are
+// copied inline, larger ones are stored out-of-line in a node pool and the queue only carries their handle.
+//
+// `PQ` is the pair-based wrapper with the same ordering (e.g. PQWrapper<false>). Each thread must use its own handle,
+// and at most `num_threads` handles may be requested.
+template <typename PQ, typename Key, typename Value, typename KeyOfValue>
+class PayloadAdaptor {
+    static_assert(std::is_same_v<Key, double> || std::is_same_v<Key, unsigned long>, "Unsupported key type");
+    static_assert(std::is_trivially_copyable_v<Value>, "Values are copied bytewise");
+
+   public:
+    using key_type = Key;
+    using value_type = Value;
+    using base_type = PQ;
+    static constexpr bool out_of_line = sizeof(Value) > sizeof(unsigned long);
+
+   private:
+    using entry_type = typename PQ::value_type;
+    using pool_type = NodePool<std::conditional_t<out_of_line, Value, unsigned long>>;
+
+    PQ pq_;
+    pool_type pool_;
+    std::atomic_int next_id_{0};
+    int num_threads_;
+
+    static unsigned long to_bits(Key key) noexcept {
+        if constexpr (std::is_same_v<Key, double>) {
+            return key_transform::to_ordered_bits(key);
+        } else {
+            return key;
+        }
+    }
+
+    static Key from_bits(unsigned long bits) noexcept {
+        if constexpr (std::is_same_v<Key, double>) {
+            return key_transform::from_ordered_bits(bits);
+        } else {
+            return bits;
+        }
+    }
+
+   public:
+    class Handle {
+        friend PayloadAdaptor;
+
+        PayloadAdaptor* adaptor_;
+        typename PQ::handle_type handle_;
+        int id_;
+
+        Handle(PayloadAdaptor& adaptor, int id) : adaptor_{&adaptor}, handle_{adaptor.pq_.get_handle()}, id_{id} {
+        }
+
+       public:
+        void push(value_type const& value) {
+            unsigned long payload = 0;
+            if constexpr (out_of_line) {
+                payload = adaptor_->pool_.allocate(id_, value);
+            } else {
+                std::memcpy(&payload, &value, sizeof(value));
+            }
+            handle_.push(entry_type{to_bits(KeyOfValue::get(value)), payload});
+        }
+
+        std::optional<value_type> try_pop() {
+            auto entry = handle_.try_pop();
+            if (!entry) {
+                return std::nullopt;
+            }
+            value_type value;
+            if constexpr (out_of_line) {
+                value = adaptor_->pool_[entry->second];
+                adaptor_->pool_.free(id_, entry->second);
+            } else {
+                std::memcpy(&value, &entry->second, sizeof(value));
+            }
+            return value;
+        }
+    };
+
+    using handle_type = Handle;
+
+    // `create` has to return the underlying queue, so that queues that cannot be moved are supported
+    template <typename Create>
+    PayloadAdaptor(int num_threads, Create&& create)
+        : pq_(std::forward<Create>(create)()), pool_{num_threads, false}, num_threads_{num_threads} {
+    }
+
+    Handle get_handle() {
+        auto id = next_id_.fetch_add(1, std::memory_order_relaxed);
+        if (id >= num_threads_) {
+            throw std::runtime_error{"More handles than threads"};
+        }
+        return Handle{*this, id};
+    }
+
+    template <typename P = PQ, typename = std::enable_if_t<wrapper::util::has_best_key_bound_v<P>>>
+    std::optional<key_type> best_key_bound() const noexcept {
+        auto bound = pq_.best_key_bound();
+        if (!bound) {
+            return std::nullopt;
+        }
+        return from_bits(*bound);
+    }
+
+    PQ const& base() const noexcept {
+        return pq_;
+    }
+
+    // Only meaningful after all threads are done
+    [[nodiscard]] std::size_t out_of_line_slots() const noexcept {
+        return out_of_line ? pool_.allocated_slots() : 0;
+    }
+
+    [[nodiscard]] static constexpr std::size_t slot_size() noexcept {
+        return pool_type::slot_size();
+    }
+};
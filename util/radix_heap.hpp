@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Monotone radix heap: inserted keys must not be smaller than the last popped key.
+// Elements are kept in buckets by the highest bit in which their key differs from the last popped key, so each
+// element moves to a lower bucket at most once per bit.
+template <typename Value, typename KeyOfValue>
+class RadixHeap {
+    using key_type = std::uint64_t;
+    static constexpr std::size_t num_buckets = sizeof(key_type) * CHAR_BIT + 1;
+
+    std::array<std::vector<Value>, num_buckets> buckets_{};
+    key_type last_{0};
+    std::size_t size_{0};
+
+    static key_type key(Value const& value) noexcept {
+        return static_cast<key_type>(KeyOfValue::get(value));
+    }
+
+    [[nodiscard]] std::size_t bucket_index(key_type k) const noexcept {
+        return k == last_ ? 0 : num_buckets - 1 - static_cast<std::size_t>(__builtin_clzll(k ^ last_));
+    }
+
+    // Moves the elements of the first nonempty bucket into lower buckets, afterwards bucket 0 is nonempty
+    void refill() {
+        assert(size_ > 0);
+        std::size_t i = 1;
+        while (buckets_[i].empty()) {
+            ++i;
+        }
+        auto min_key = std::numeric_limits<key_type>::max();
+        for (auto const& v : buckets_[i]) {
+            min_key = std::min(min_key, key(v));
+        }
+        last_ = min_key;
+        for (auto const& v : buckets_[i]) {
+            buckets_[bucket_index(key(v))].push_back(v);
+        }
+        buckets_[i].clear();
+    }
+
+   public:
+    void push(Value const& value) {
+        assert(key(value) >= last_);
+        buckets_[bucket_index(key(value))].push_back(value);
+        ++size_;
+    }
+
+    Value const& top() {
+        if (buckets_[0].empty()) {
+            refill();
+        }
+        return buckets_[0].back();
+    }
+
+    void pop() {
+        if (buckets_[0].empty()) {
+            refill();
+        }
+        buckets_[0].pop_back();
+        --size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_;
+    }
+};
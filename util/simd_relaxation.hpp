@@ -0,0 +1,72 @@
+#pragma once
+
+#include "graph.hpp"
+
+#if defined __AVX512F__ || defined __AVX2__
+#include <immintrin.h>
+#endif
+#include <cstddef>
+
+namespace simd {
+
+// Number of edges relaxed per vector, 1 if no vector instructions are available
+#if defined __AVX512F__
+static constexpr std::size_t lanes = 8;
+#elif defined __AVX2__
+static constexpr std::size_t lanes = 4;
+#else
+static constexpr std::size_t lanes = 1;
+#endif
+
+// Calls `relax(target, distance + weight)` for the edges in [begin, end) of the split edge layout. Full vectors only
+// call `relax` for the lanes whose candidate is smaller than the target's current distance, which is gathered from
+// `distances[target * Stride]` without synchronization. The caller has to recheck the distance atomically.
+template <std::size_t Stride, typename Relax>
+void relax_edges(Graph const& graph, std::size_t begin, std::size_t end, long long distance,
+                 long long const* distances, Relax&& relax) {
+    static_assert((Stride & (Stride - 1)) == 0, "Stride must be a power of two");
+    auto i = begin;
+#if defined __AVX512F__ || defined __AVX2__
+    constexpr int stride_shift = __builtin_ctzll(Stride);
+    auto const* targets = reinterpret_cast<long long const*>(graph.edge_targets.data());
+    auto const* weights = graph.edge_weights.data();
+#endif
+#if defined __AVX512F__
+    auto const distance_vec = _mm512_set1_epi64(distance);
+    for (; i + lanes <= end; i += lanes) {
+        auto target_vec = _mm512_loadu_si512(targets + i);
+        auto candidate_vec = _mm512_add_epi64(distance_vec, _mm512_loadu_si512(weights + i));
+        // The masked forms take a zero source instead of an undefined one, which GCC flags with -Wmaybe-uninitialized
+        auto offset_vec = _mm512_maskz_slli_epi64(0xFF, target_vec, stride_shift);
+        auto current_vec = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xFF, offset_vec, distances, 8);
+        unsigned mask = _mm512_cmpgt_epi64_mask(current_vec, candidate_vec);
+        while (mask != 0) {
+            auto lane = static_cast<std::size_t>(__builtin_ctz(mask));
+            relax(graph.edge_targets[i + lane], distance + weights[i + lane]);
+            mask &= mask - 1;
+        }
+    }
+#elif defined __AVX2__
+    auto const distance_vec = _mm256_set1_epi64x(distance);
+    for (; i + lanes <= end; i += lanes) {
+        auto target_vec = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(targets + i));
+        auto candidate_vec =
+            _mm256_add_epi64(distance_vec, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(weights + i)));
+        auto current_vec = _mm256_i64gather_epi64(distances, _mm256_slli_epi64(target_vec, stride_shift), 8);
+        auto mask = static_cast<unsigned>(
+            _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(current_vec, candidate_vec))));
+        while (mask != 0) {
+            auto lane = static_cast<std::size_t>(__builtin_ctz(mask));
+            relax(graph.edge_targets[i + lane], distance + weights[i + lane]);
+            mask &= mask - 1;
+        }
+    }
+#else
+    (void)distances;
+#endif
+    for (; i < end; ++i) {
+        relax(graph.edge_targets[i], distance + graph.edge_weights[i]);
+    }
+}
+
+}  // namespace simd
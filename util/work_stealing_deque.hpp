@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque with the memory orders of Lê et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models" (PPoPP 2013). The owner pushes and pops at the bottom, other threads steal from the top. The ring
+// buffer doubles when full. Replaced buffers are kept until the deque is destroyed, since thieves may still read
+// them, so the memory of a deque is at most twice its largest buffer.
+//
+// Elements are stored as relaxed atomic words, so a thief reading a slot that the owner overwrites is no data race.
+// Such a read is discarded by the failing compare-and-swap on `top_`.
+template <typename T>
+class WorkStealingDeque {
+    // Not std::is_trivially_copyable, which excludes std::pair
+    static_assert(std::is_trivially_copy_constructible_v<T> && std::is_trivially_destructible_v<T> &&
+                      std::is_default_constructible_v<T>,
+                  "Elements are copied wordwise");
+
+    static constexpr std::size_t words = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    struct Buffer {
+        std::int64_t capacity;
+        std::unique_ptr<std::array<std::atomic<std::uint64_t>, words>[]> slots;
+
+        explicit Buffer(std::int64_t capacity_)
+            : capacity{capacity_},
+              slots{new std::array<std::atomic<std::uint64_t>, words>[static_cast<std::size_t>(capacity_)]} {
+        }
+
+        void put(std::int64_t index, T const& element) noexcept {
+            std::array<std::uint64_t, words> raw{};
+            std::memcpy(raw.data(), &element, sizeof(T));
+            auto& slot = slots[static_cast<std::size_t>(index & (capacity - 1))];
+            for (std::size_t i = 0; i < words; ++i) {
+                slot[i].store(raw[i], std::memory_order_relaxed);
+            }
+        }
+
+        T get(std::int64_t index) const noexcept {
+            std::array<std::uint64_t, words> raw{};
+            auto const& slot = slots[static_cast<std::size_t>(index & (capacity - 1))];
+            for (std::size_t i = 0; i < words; ++i) {
+                raw[i] = slot[i].load(std::memory_order_relaxed);
+            }
+            T element;
+            // The cast silences -Wclass-memaccess for types like std::pair with a user-provided assignment
+            std::memcpy(static_cast<void*>(&element), raw.data(), sizeof(T));
+            return element;
+        }
+    };
+
+    alignas(L1_CACHE_LINESIZE) std::atomic<std::int64_t> top_{0};
+    alignas(L1_CACHE_LINESIZE) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<Buffer*> buffer_;
+    // Owner only
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+    std::int64_t max_size_ = 0;
+
+    Buffer* grow(Buffer* old, std::int64_t top, std::int64_t bottom) {
+        auto bigger = std::make_unique<Buffer>(old->capacity * 2);
+        for (auto i = top; i < bottom; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        buffers_.push_back(std::move(bigger));
+        buffer_.store(buffers_.back().get(), std::memory_order_release);
+        return buffers_.back().get();
+    }
+
+   public:
+    // `initial_capacity` is rounded up to a power of two
+    explicit WorkStealingDeque(std::size_t initial_capacity = 1024) {
+        std::int64_t capacity = 1;
+        while (capacity < static_cast<std::int64_t>(initial_capacity)) {
+            capacity *= 2;
+        }
+        buffers_.push_back(std::make_unique<Buffer>(capacity));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    // Owner only
+    void push(T const& element) {
+        auto bottom = bottom_.load(std::memory_order_relaxed);
+        auto top = top_.load(std::memory_order_acquire);
+        auto* buffer = buffer_.load(std::memory_order_relaxed);
+        if (bottom - top > buffer->capacity - 1) {
+            buffer = grow(buffer, top, bottom);
+        }
+        buffer->put(bottom, element);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        max_size_ = std::max(max_size_, bottom + 1 - top);
+    }
+
+    // Owner only, returns the most recently pushed element
+    std::optional<T> pop() {
+        auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        auto* buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = top_.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        auto element = buffer->get(bottom);
+        if (top == bottom) {
+            // Last element, race against thieves
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return std::nullopt;
+            }
+        }
+        return element;
+    }
+
+    // Returns the least recently pushed element, fails spuriously if another thread takes an element concurrently
+    std::optional<T> steal() {
+        auto top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return std::nullopt;
+        }
+        auto element = buffer_.load(std::memory_order_acquire)->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return element;
+    }
+
+    // Only meaningful after all threads are done
+    [[nodiscard]] std::size_t max_size() const noexcept {
+        return static_cast<std::size_t>(max_size_);
+    }
+
+    // Bytes of all buffers including the replaced ones, only meaningful after all threads are done
+    [[nodiscard]] std::size_t allocated_bytes() const noexcept {
+        std::size_t total = 0;
+        for (auto const& buffer : buffers_) {
+            total += static_cast<std::size_t>(buffer->capacity) * sizeof(std::array<std::atomic<std::uint64_t>, words>);
+        }
+        return total;
+    }
+};
@@ -4,6 +4,7 @@
 
 #include "cxxopts.hpp"
 
+#include <atomic>
 #include <cstddef>
 #include <mutex>
 #include <optional>
@@ -27,6 +28,18 @@ class LockedPQ {
 
     pq_type pq_{};
     std::mutex m_;
+    // Copy of the top key, written under the lock so that best_key_bound() does not need it
+    std::atomic<key_type> top_key_{};
+    std::atomic_bool empty_{true};
+
+    void update_top() noexcept {
+        if (pq_.empty()) {
+            empty_.store(true, std::memory_order_relaxed);
+        } else {
+            top_key_.store(KeyOfValue::get(pq_.top()), std::memory_order_relaxed);
+            empty_.store(false, std::memory_order_release);
+        }
+    }
 
    public:
     LockedPQ(std::size_t initial_capacity) {
@@ -38,6 +51,7 @@ class LockedPQ {
     void push(value_type const& value) {
         std::lock_guard<std::mutex> lock{m_};
         pq_.push(value);
+        update_top();
     }
 
     std::optional<value_type> try_pop() {
@@ -47,9 +61,17 @@ class LockedPQ {
         }
         auto retval = pq_.top();
         pq_.pop();
+        update_top();
         return retval;
     }
 
+    std::optional<key_type> best_key_bound() const noexcept {
+        if (empty_.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        return top_key_.load(std::memory_order_relaxed);
+    }
+
     handle_type get_handle() {
         return *this;
     }
@@ -38,6 +38,9 @@ using namespace wrapper::stealing_mq;
 #elif defined PQ_LOCKED_PQ
 #include "wrapper/locked_pq.hpp"
 using namespace wrapper::locked_pq;
+#elif defined PQ_WORK_STEALING
+#include "wrapper/work_stealing.hpp"
+using namespace wrapper::work_stealing;
 #else
 #error No valid PQ specified
 #endif
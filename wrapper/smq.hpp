@@ -64,14 +64,15 @@ class StealingMQ {
 
    private:
     pq_type pq_;
+    // Per queue, so that queues created one after another again hand out ids starting from 0
+    std::atomic_int next_id_{0};
 
    public:
     explicit StealingMQ(int num_threads) : pq_(num_threads) {
     }
 
     Handle get_handle() {
-        static std::atomic_int id{0};
-        return Handle{&pq_, id.fetch_add(1)};
+        return Handle{&pq_, next_id_.fetch_add(1)};
     }
 };
 
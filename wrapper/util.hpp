@@ -36,4 +36,16 @@ class ValueCompare {
     }
 };
 
+// Queues may provide `best_key_bound()`, returning a key at least as good as every key currently in the queue, or
+// std::nullopt if the queue is empty. It is a snapshot and may miss elements whose push has not yet returned.
+template <typename PQ, typename = void>
+struct has_best_key_bound : std::false_type {};
+
+template <typename PQ>
+struct has_best_key_bound<PQ, std::void_t<decltype(std::declval<PQ const&>().best_key_bound())>> : std::true_type {
+};
+
+template <typename PQ>
+inline constexpr bool has_best_key_bound_v = has_best_key_bound<PQ>::value;
+
 }  // namespace wrapper::util
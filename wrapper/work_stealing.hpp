@@ -0,0 +1,120 @@
+#pragma once
+
+#include "util.hpp"
+#include "work_stealing_deque.hpp"
+
+#include "cxxopts.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <utility>
+
+namespace wrapper::work_stealing {
+
+// Not a priority queue but the usual depth-first baseline: every thread works on its own Chase-Lev deque in LIFO
+// order and steals the oldest element of random victims when it runs empty. Keys are ignored.
+template <bool Min = true, typename Key = unsigned long, typename Value = std::pair<unsigned long, unsigned long>,
+          typename KeyOfValue = util::KeyOfValue<Key, Value>>
+class WorkStealing {
+   public:
+    using key_type = Key;
+    using value_type = Value;
+
+   private:
+    struct alignas(L1_CACHE_LINESIZE) Worker {
+        WorkStealingDeque<value_type> deque;
+    };
+
+    std::unique_ptr<Worker[]> workers_;
+    int num_threads_;
+    // The id of a handle selects its thread's own deque in `workers_`
+    std::atomic_int next_id_{0};
+
+    class Handle {
+        friend WorkStealing;
+
+        WorkStealing* ws_;
+        int id_;
+        std::minstd_rand rng_;
+
+        Handle(WorkStealing* ws, int id) : ws_{ws}, id_{id}, rng_{static_cast<std::minstd_rand::result_type>(id + 1)} {
+        }
+
+       public:
+        void push(value_type const& value) {
+            ws_->workers_[static_cast<std::size_t>(id_)].deque.push(value);
+        }
+
+        // Tries each other thread once on average before giving up
+        std::optional<value_type> try_pop() {
+            if (auto value = ws_->workers_[static_cast<std::size_t>(id_)].deque.pop(); value) {
+                return value;
+            }
+            for (int i = 1; i < ws_->num_threads_; ++i) {
+                auto victim = static_cast<int>(rng_() % static_cast<unsigned int>(ws_->num_threads_ - 1));
+                if (victim >= id_) {
+                    ++victim;
+                }
+                if (auto value = ws_->workers_[static_cast<std::size_t>(victim)].deque.steal(); value) {
+                    return value;
+                }
+            }
+            return std::nullopt;
+        }
+    };
+
+   public:
+    using handle_type = Handle;
+
+    explicit WorkStealing(int num_threads)
+        : workers_{new Worker[static_cast<std::size_t>(num_threads)]}, num_threads_{num_threads} {
+    }
+
+    Handle get_handle() {
+        return Handle{this, next_id_.fetch_add(1)};
+    }
+
+    // Sum of the largest sizes of the deques, only meaningful after all threads are done
+    [[nodiscard]] std::size_t max_size() const noexcept {
+        std::size_t total = 0;
+        for (int i = 0; i < num_threads_; ++i) {
+            total += workers_[static_cast<std::size_t>(i)].deque.max_size();
+        }
+        return total;
+    }
+
+    // Only meaningful after all threads are done
+    [[nodiscard]] std::size_t allocated_bytes() const noexcept {
+        std::size_t total = 0;
+        for (int i = 0; i < num_threads_; ++i) {
+            total += workers_[static_cast<std::size_t>(i)].deque.allocated_bytes();
+        }
+        return total;
+    }
+};
+
+template <bool Min = true, typename Key = unsigned long, typename Value = std::pair<unsigned long, unsigned long>,
+          typename KeyOfValue = util::KeyOfValue<Key, Value>>
+using PQWrapper = WorkStealing<Min, Key, Value, KeyOfValue>;
+
+inline void add_options(cxxopts::Options& /*options*/) {
+}
+
+template <bool Min = true, typename Key = unsigned long, typename Value = std::pair<unsigned long, unsigned long>,
+          typename KeyOfValue = util::KeyOfValue<Key, Value>>
+WorkStealing<Min, Key, Value, KeyOfValue> create(int num_threads, std::size_t /*initial_capacity*/,
+                                                 cxxopts::ParseResult const& /*result*/) {
+    return WorkStealing<Min, Key, Value, KeyOfValue>{num_threads};
+}
+
+template <typename PQ>
+std::ostream& describe(PQ const& /*pq*/, std::ostream& out) {
+    out << "Work-stealing deques (Chase-Lev, depth-first)";
+    return out;
+}
+
+}  // namespace wrapper::work_stealing